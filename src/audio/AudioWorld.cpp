@@ -21,7 +21,9 @@
 #include <daedalus/DATFile.h>
 #include <daedalus/DaedalusGameState.h>
 #include <daedalus/DaedalusVM.h>
+#include <logic/SavegameManager.h>
 #include <logic/ScriptEngine.h>
+#include <utils/cli.h>
 #include <utils/logger.h>
 
 #include "engine/BaseEngine.h"
@@ -32,6 +34,17 @@
 
 using namespace Audio;
 
+namespace Flags
+{
+    Cli::Flag musicCache("", "music-cache", 1, "Pre-renders music-segments in the background and plays them as loops, so the synthesizer doesn't have to run all the time. Possible options: off, memory, disk", {"off"}, "Sound");
+    Cli::Flag musicCacheLength("", "music-cache-length", 1, "Length in seconds of the loops rendered by --music-cache", {"60"}, "Sound");
+}
+
+/**
+ * Length of the crossfade when switching between cached and synthesized music, in frames
+ */
+const size_t MUSIC_CROSSFADE_FRAMES = 44100 / 2;
+
 static DirectMusic::SegmentTiming getTiming(std::uint32_t v) {
     switch (v) {
     case Daedalus::GEngineClasses::TRANSITION_SUB_TYPE_BEAT:
@@ -123,14 +136,63 @@ namespace World
 
             m_musicContext->provideLoader(loader);
 
+            std::map<std::string, std::string> segmentFiles;
             for (const auto& segment : Utils::getFilesInDirectory(musicPath, "sgt")) {
                 const auto lowercaseName = Utils::lowered(Utils::stripFilePath(segment));
                 const auto segm = m_musicContext->loadSegment(segment);
                 LogInfo() << "Loading " + segment;
                 m_Segments[lowercaseName] = m_musicContext->prepareSegment(*segm);
+                segmentFiles[lowercaseName] = segment;
             }
             LogInfo() << "All segments loaded.";
 
+            std::string cacheMode = Flags::musicCache.getParam(0);
+            if (cacheMode == "memory" || cacheMode == "disk") {
+                // The synthesizer isn't thread-safe, so every segment gets rendered on a context of its own
+                auto renderer = [segmentFiles, loader](const std::string& name, std::vector<std::int16_t>& pcm, const std::atomic<bool>& abort) {
+                    DirectMusic::PlayingContext context(44100, 2, DirectMusic::DlsPlayer::createFactory());
+                    context.provideLoader(loader);
+
+                    const auto segm = context.loadSegment(segmentFiles.at(name));
+                    context.playSegment(context.prepareSegment(*segm), DirectMusic::SegmentTiming::Immediate);
+
+                    std::int16_t buf[RE_MUSIC_BUFFER_LEN];
+                    for (size_t i = 0; i < pcm.size(); i += RE_MUSIC_BUFFER_LEN) {
+                        if (abort)
+                            return false;
+
+                        context.renderBlock(buf, RE_MUSIC_BUFFER_LEN);
+                        std::copy(buf, buf + std::min<size_t>(RE_MUSIC_BUFFER_LEN, pcm.size() - i), pcm.begin() + i);
+                    }
+                    return true;
+                };
+
+                std::string directory;
+                if (cacheMode == "disk") {
+                    std::string userdata = Utils::getUserDataLocation();
+                    directory = userdata + "/" + Engine::SavegameManager::gameSpecificSubFolderName() + "/musiccache";
+
+                    if (!Utils::mkdir(userdata)
+                        || !Utils::mkdir(userdata + "/" + Engine::SavegameManager::gameSpecificSubFolderName())
+                        || !Utils::mkdir(directory)) {
+                        LogError() << "Failed to create music-cache directory at: " << directory;
+                        directory.clear();
+                    }
+                }
+
+                double seconds = std::max(1.0, atof(Flags::musicCacheLength.getParam(0).c_str()));
+                m_musicCache = std::make_unique<MusicCache>(44100, 2, static_cast<size_t>(seconds * 44100), directory, renderer);
+
+                // On disk, every theme only needs to be rendered once, so do all of them in the background.
+                // Memory only holds a few, those are rendered once played.
+                if (!directory.empty()) {
+                    for (const auto& theme : m_musicThemeSegments) {
+                        if (segmentFiles.count(Utils::lowered(theme.second)))
+                            m_musicCache->request(Utils::lowered(theme.second));
+                    }
+                }
+            }
+
             alGenBuffers(RE_NUM_MUSIC_BUFFERS, m_musicBuffers);
             alGenSources(1, &m_musicSource);
 
@@ -166,7 +228,7 @@ namespace World
             return;
         }
 
-        m_musicContext->renderBlock(buf, RE_MUSIC_BUFFER_LEN);
+        renderMusic(buf);
 
         while (!m_exiting)
         {
@@ -190,7 +252,7 @@ namespace World
                     LogError() << "Error while buffering: " << AudioEngine::getErrorString(error);
                     return;
                 }
-                m_musicContext->renderBlock(buf, RE_MUSIC_BUFFER_LEN);
+                renderMusic(buf);
             }
 
             alGetSourcei(m_musicSource, AL_SOURCE_STATE, &val);
@@ -198,6 +260,46 @@ namespace World
                 alSourcePlay(m_musicSource);
         }
     }
+
+    void AudioWorld::renderMusic(std::int16_t* buf)
+    {
+        std::lock_guard<std::mutex> lock(m_musicMutex);
+
+        // Segment playing live got cached in the meantime
+        if (m_musicCache && !m_musicCursor.isValid() && m_musicFadeRemaining == 0 && !m_playingSegment.empty()) {
+            auto cached = m_musicCache->get(m_playingSegment);
+            if (cached) {
+                m_musicFadeCursor = MusicCache::Cursor();
+                m_musicFadeRemaining = MUSIC_CROSSFADE_FRAMES;
+                m_musicCursor = MusicCache::Cursor(cached, 2);
+            }
+        }
+
+        renderMusic(m_musicCursor, buf);
+
+        if (m_musicFadeRemaining > 0) {
+            std::int16_t previous[RE_MUSIC_BUFFER_LEN];
+            renderMusic(m_musicFadeCursor, previous);
+
+            for (int i = 0; i < RE_MUSIC_BUFFER_LEN / 2 && m_musicFadeRemaining > 0; i++) {
+                float t = static_cast<float>(m_musicFadeRemaining--) / MUSIC_CROSSFADE_FRAMES;
+
+                for (int c = 0; c < 2; c++)
+                    buf[i * 2 + c] = static_cast<std::int16_t>(buf[i * 2 + c] * (1.0f - t) + previous[i * 2 + c] * t);
+            }
+
+            if (m_musicFadeRemaining == 0)
+                m_musicFadeCursor = MusicCache::Cursor();
+        }
+    }
+
+    void AudioWorld::renderMusic(MusicCache::Cursor& cursor, std::int16_t* buf)
+    {
+        if (cursor.isValid())
+            cursor.render(buf, RE_MUSIC_BUFFER_LEN);
+        else
+            m_musicContext->renderBlock(buf, RE_MUSIC_BUFFER_LEN);
+    }
 #endif
 
     AudioWorld::~AudioWorld()
@@ -206,6 +308,9 @@ namespace World
         m_exiting = true;
         m_musicRenderThread.join();
 
+        // Might still be rendering, which it stops before the next block
+        m_musicCache.reset();
+
         alDeleteBuffers(RE_NUM_MUSIC_BUFFERS, m_musicBuffers);
         alDeleteSources(1, &m_musicSource);
 
@@ -715,9 +820,30 @@ namespace World
         }
         else
         {
+            std::lock_guard<std::mutex> lock(m_musicMutex);
+
             if (m_playingSegment != loweredName)
             {
-                m_musicContext->playSegment(m_Segments.at(loweredName), timing);
+                auto cached = m_musicCache ? m_musicCache->get(loweredName) : nullptr;
+
+                if (m_musicCache && !cached)
+                    m_musicCache->request(loweredName, true);
+
+                // Cached segments can't do the transitions of the synthesizer, so fade over to/from them instead
+                bool fade = cached || m_musicCursor.isValid();
+                m_musicFadeCursor = m_musicCursor;
+                m_musicFadeRemaining = fade ? MUSIC_CROSSFADE_FRAMES : 0;
+
+                if (cached)
+                {
+                    m_musicCursor = MusicCache::Cursor(cached, 2);
+                }
+                else
+                {
+                    m_musicCursor = MusicCache::Cursor();
+                    m_musicContext->playSegment(m_Segments.at(loweredName), fade ? DirectMusic::SegmentTiming::Immediate : timing);
+                }
+
                 m_playingSegment = loweredName;
             }
             return true;
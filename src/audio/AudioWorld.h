@@ -2,6 +2,7 @@
 
 #include <list>
 #include <map>
+#include <mutex>
 #include <thread>
 
 #include <glm/glm.hpp>
@@ -12,6 +13,7 @@
 #include <memory/Config.h>
 #include <utils/Utils.h>
 #include <vdfs/fileIndex.h>
+#include "MusicCache.h"
 
 typedef struct ALCcontext_struct ALCcontext;
 
@@ -221,6 +223,33 @@ namespace World
         void musicRenderFunction();
         std::thread m_musicRenderThread;
 
+        /**
+         * Fills the buffer with the next RE_MUSIC_BUFFER_LEN samples of music, from the cache if possible
+         */
+        void renderMusic(std::int16_t* buf);
+        void renderMusic(Audio::MusicCache::Cursor& cursor, std::int16_t* buf);
+
+        /**
+         * Pre-rendered segments, nullptr if music is always synthesized live
+         */
+        std::unique_ptr<Audio::MusicCache> m_musicCache;
+
+        /**
+         * Position in the cached segment currently playing. Invalid while the synthesizer plays.
+         */
+        Audio::MusicCache::Cursor m_musicCursor;
+
+        /**
+         * What played before the last switch, while it is faded out. Invalid if that was the synthesizer.
+         */
+        Audio::MusicCache::Cursor m_musicFadeCursor;
+        size_t m_musicFadeRemaining = 0;
+
+        /**
+         * Guards the playing segment, cursors and fading between the game- and the music-thread
+         */
+        std::mutex m_musicMutex;
+
         /**
          * Contain music buffers and source
          */
@@ -0,0 +1,316 @@
+#include "MusicCache.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <adpcm/adpcm-lib.h>
+#include <utils/logger.h>
+
+using namespace Audio;
+
+/**
+ * Length of the crossfade from the end of a loop into its start, in seconds
+ */
+const float LOOP_CROSSFADE_SECONDS = 2.0f;
+
+/**
+ * Number of segments kept in memory. With the default length of a minute, one takes about 2.5MB.
+ */
+const size_t MAX_SEGMENTS_IN_MEMORY = 8;
+
+/**
+ * Written at the start of every cache-file. Bump the version when the format changes.
+ */
+const char CACHE_FILE_MAGIC[4] = {'R', 'E', 'M', 'C'};
+const uint32_t CACHE_FILE_VERSION = 1;
+
+namespace
+{
+    size_t getBlockSize(unsigned channels)
+    {
+        // Header of 4 bytes per channel, then 4 bytes per 8 frames and channel
+        return channels * (4 + (MusicCache::BLOCK_FRAMES - 1) / 2);
+    }
+}
+
+const size_t MusicCache::BLOCK_FRAMES;
+
+MusicCache::Cursor::Cursor(std::shared_ptr<const Segment> segment, unsigned channels)
+    : m_Segment(std::move(segment))
+    , m_Channels(channels)
+{
+}
+
+void MusicCache::Cursor::render(int16_t* out, size_t numSamples)
+{
+    size_t blockSize = getBlockSize(m_Channels);
+
+    for (size_t i = 0; i < numSamples / m_Channels; i++)
+    {
+        size_t block = m_Frame / BLOCK_FRAMES;
+        if (block != m_DecodedBlock)
+        {
+            m_Block.resize(BLOCK_FRAMES * m_Channels);
+            adpcm_decode_block(m_Block.data(), &m_Segment->blocks[block * blockSize], blockSize, m_Channels);
+            m_DecodedBlock = block;
+        }
+
+        const int16_t* frame = &m_Block[(m_Frame % BLOCK_FRAMES) * m_Channels];
+        for (unsigned c = 0; c < m_Channels; c++)
+            *out++ = frame[c];
+
+        m_Frame++;
+        if (m_Frame >= m_Segment->numFrames)
+            m_Frame = 0;
+    }
+}
+
+MusicCache::MusicCache(unsigned sampleRate, unsigned channels, size_t loopFrames, const std::string& directory, Renderer renderer)
+    : m_SampleRate(sampleRate)
+    , m_Channels(channels)
+    , m_LoopFrames(loopFrames)
+    , m_Directory(directory)
+    , m_Renderer(std::move(renderer))
+    , m_Exiting(false)
+{
+    m_Worker = std::thread(&MusicCache::workerFunction, this);
+}
+
+MusicCache::~MusicCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Exiting = true;
+    }
+
+    m_Wakeup.notify_one();
+    m_Worker.join();
+}
+
+void MusicCache::request(const std::string& name, bool urgent)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        if (m_Segments.count(name) || m_Failed.count(name))
+            return;
+
+        auto it = std::find(m_Queue.begin(), m_Queue.end(), name);
+        if (it != m_Queue.end())
+        {
+            if (!urgent)
+                return;
+
+            m_Queue.erase(it);
+        }
+
+        if (urgent)
+            m_Queue.push_front(name);
+        else
+            m_Queue.push_back(name);
+    }
+
+    m_Wakeup.notify_one();
+}
+
+std::shared_ptr<const MusicCache::Segment> MusicCache::get(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto it = m_Segments.find(name);
+    if (it == m_Segments.end())
+        return nullptr;
+
+    auto used = std::find(m_RecentlyUsed.begin(), m_RecentlyUsed.end(), name);
+    m_RecentlyUsed.splice(m_RecentlyUsed.begin(), m_RecentlyUsed, used);
+
+    return it->second;
+}
+
+void MusicCache::workerFunction()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    while (true)
+    {
+        m_Wakeup.wait(lock, [this]() { return m_Exiting || !m_Queue.empty(); });
+
+        if (m_Exiting)
+            return;
+
+        std::string name = m_Queue.front();
+        m_Queue.pop_front();
+
+        // Might have been requested again while it was being worked on
+        if (m_Segments.count(name) || m_Failed.count(name))
+            continue;
+
+        lock.unlock();
+
+        std::shared_ptr<Segment> segment = loadFromDisk(name);
+        if (!segment)
+        {
+            segment = render(name);
+
+            if (segment && !m_Directory.empty())
+                saveToDisk(name, *segment);
+        }
+
+        lock.lock();
+
+        if (m_Exiting)
+            return;
+
+        if (segment)
+            store(name, segment);
+        else
+            m_Failed.insert(name);
+    }
+}
+
+std::shared_ptr<MusicCache::Segment> MusicCache::render(const std::string& name)
+{
+    size_t fadeFrames = std::min(static_cast<size_t>(LOOP_CROSSFADE_SECONDS * m_SampleRate), m_LoopFrames / 4);
+
+    std::vector<int16_t> pcm((m_LoopFrames + fadeFrames) * m_Channels, 0);
+
+    try
+    {
+        if (!m_Renderer(name, pcm, m_Exiting))
+            return nullptr;
+    }
+    catch (const std::exception& e)
+    {
+        LogWarn() << "Failed to render music-segment " << name << ": " << e.what();
+        return nullptr;
+    }
+
+    // Whatever played past the end of the loop fades into its start, so there is no gap when it wraps around
+    for (size_t i = 0; i < fadeFrames; i++)
+    {
+        float t = static_cast<float>(i) / fadeFrames;
+
+        for (unsigned c = 0; c < m_Channels; c++)
+        {
+            int16_t& start = pcm[i * m_Channels + c];
+            int16_t tail = pcm[(m_LoopFrames + i) * m_Channels + c];
+
+            start = static_cast<int16_t>(start * t + tail * (1.0f - t));
+        }
+    }
+
+    pcm.resize(m_LoopFrames * m_Channels);
+
+    auto segment = std::make_shared<Segment>();
+    segment->numFrames = m_LoopFrames;
+
+    size_t numBlocks = (m_LoopFrames + BLOCK_FRAMES - 1) / BLOCK_FRAMES;
+    size_t blockSize = getBlockSize(m_Channels);
+    segment->blocks.resize(numBlocks * blockSize);
+
+    // Same as adpcm-xq: Start with the average step of the first block
+    int32_t averageDeltas[2] = {0, 0};
+    for (size_t i = std::min(BLOCK_FRAMES, m_LoopFrames) - 1; i > 0; i--)
+    {
+        for (unsigned c = 0; c < std::min(m_Channels, 2u); c++)
+        {
+            averageDeltas[c] -= averageDeltas[c] >> 3;
+            averageDeltas[c] += std::abs(pcm[i * m_Channels + c] - pcm[(i - 1) * m_Channels + c]);
+        }
+    }
+
+    averageDeltas[0] >>= 3;
+    averageDeltas[1] >>= 3;
+
+    void* context = adpcm_create_context(m_Channels, 2, NOISE_SHAPING_STATIC, averageDeltas);
+
+    std::vector<int16_t> block(BLOCK_FRAMES * m_Channels);
+    for (size_t b = 0; b < numBlocks; b++)
+    {
+        size_t first = b * BLOCK_FRAMES;
+        size_t count = std::min(BLOCK_FRAMES, m_LoopFrames - first);
+
+        // Last one is padded with silence
+        std::fill(block.begin(), block.end(), 0);
+        std::copy(pcm.begin() + first * m_Channels, pcm.begin() + (first + count) * m_Channels, block.begin());
+
+        size_t written;
+        adpcm_encode_block(context, &segment->blocks[b * blockSize], &written, block.data(), BLOCK_FRAMES);
+    }
+
+    adpcm_free_context(context);
+
+    return segment;
+}
+
+std::shared_ptr<MusicCache::Segment> MusicCache::loadFromDisk(const std::string& name)
+{
+    if (m_Directory.empty())
+        return nullptr;
+
+    std::ifstream f(getCacheFile(name), std::ios::binary);
+    if (!f)
+        return nullptr;
+
+    char magic[4];
+    uint32_t header[4];  // Version, samplerate, channels, frames
+
+    f.read(magic, sizeof(magic));
+    f.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    // Anything rendered with other settings is simply rendered again
+    if (!f
+        || memcmp(magic, CACHE_FILE_MAGIC, sizeof(magic)) != 0
+        || header[0] != CACHE_FILE_VERSION
+        || header[1] != m_SampleRate
+        || header[2] != m_Channels
+        || header[3] != m_LoopFrames)
+        return nullptr;
+
+    auto segment = std::make_shared<Segment>();
+    segment->numFrames = header[3];
+    segment->blocks.resize((segment->numFrames + BLOCK_FRAMES - 1) / BLOCK_FRAMES * getBlockSize(m_Channels));
+
+    f.read(reinterpret_cast<char*>(segment->blocks.data()), segment->blocks.size());
+    if (!f)
+    {
+        LogWarn() << "Music-cache file is truncated: " << getCacheFile(name);
+        return nullptr;
+    }
+
+    return segment;
+}
+
+void MusicCache::saveToDisk(const std::string& name, const Segment& segment)
+{
+    std::ofstream f(getCacheFile(name), std::ios::binary);
+    if (!f)
+    {
+        LogWarn() << "Failed to write music-cache file: " << getCacheFile(name);
+        return;
+    }
+
+    uint32_t header[4] = {CACHE_FILE_VERSION, m_SampleRate, m_Channels, static_cast<uint32_t>(segment.numFrames)};
+
+    f.write(CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+    f.write(reinterpret_cast<const char*>(header), sizeof(header));
+    f.write(reinterpret_cast<const char*>(segment.blocks.data()), segment.blocks.size());
+}
+
+std::string MusicCache::getCacheFile(const std::string& name) const
+{
+    return m_Directory + "/" + name + ".adpcm";
+}
+
+void MusicCache::store(const std::string& name, std::shared_ptr<const Segment> segment)
+{
+    m_Segments[name] = std::move(segment);
+    m_RecentlyUsed.push_front(name);
+
+    // Segments still playing are kept alive by their cursor
+    while (m_RecentlyUsed.size() > MAX_SEGMENTS_IN_MEMORY)
+    {
+        m_Segments.erase(m_RecentlyUsed.back());
+        m_RecentlyUsed.pop_back();
+    }
+}
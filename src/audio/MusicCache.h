@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Audio
+{
+    /**
+     * Keeps music-segments pre-rendered as a loop of compressed (IMA-ADPCM) samples, so the software-synthesizer
+     * only has to run once per segment instead of all the time. Segments are rendered on a background-thread
+     * and can also be stored on disk, so later sessions only need to load them.
+     *
+     * A cached segment is a fixed-length loop, the end crossfaded into the start. Variations the synthesizer would
+     * play after that are lost.
+     */
+    class MusicCache
+    {
+    public:
+        /**
+         * Renders the given segment from its start
+         * @param name Name of the segment, as passed to request()
+         * @param pcm Interleaved output samples. Has room for the requested number of frames.
+         * @param abort Set when the cache is destroyed. Rendering should stop then and return false.
+         * @return Whether rendering worked
+         */
+        typedef std::function<bool(const std::string& name, std::vector<int16_t>& pcm, const std::atomic<bool>& abort)> Renderer;
+
+        struct Segment
+        {
+            /**
+             * ADPCM-blocks of BLOCK_FRAMES frames each. The last one may be only partially used.
+             */
+            std::vector<uint8_t> blocks;
+
+            /**
+             * Length of the loop
+             */
+            size_t numFrames = 0;
+        };
+
+        /**
+         * Plays back a cached segment in a loop
+         */
+        class Cursor
+        {
+        public:
+            Cursor() = default;
+            Cursor(std::shared_ptr<const Segment> segment, unsigned channels);
+
+            /**
+             * Decodes the next samples, wrapping around at the end of the loop
+             * @param numSamples Number of interleaved samples to write, same as with PlayingContext::renderBlock
+             */
+            void render(int16_t* out, size_t numSamples);
+
+            bool isValid() const { return m_Segment != nullptr; }
+
+        private:
+            std::shared_ptr<const Segment> m_Segment;
+            unsigned m_Channels = 0;
+
+            /**
+             * Position in the loop
+             */
+            size_t m_Frame = 0;
+
+            /**
+             * Decoded samples of the block the position is in
+             */
+            std::vector<int16_t> m_Block;
+            size_t m_DecodedBlock = SIZE_MAX;
+        };
+
+        /**
+         * @param loopFrames Length of the loops to render
+         * @param directory Where to store rendered segments. Empty to keep them in memory only.
+         */
+        MusicCache(unsigned sampleRate, unsigned channels, size_t loopFrames, const std::string& directory, Renderer renderer);
+        ~MusicCache();
+
+        /**
+         * Queues the given segment to be loaded from disk or rendered, if it isn't cached already
+         * @param urgent Whether to do this one before all others queued
+         */
+        void request(const std::string& name, bool urgent = false);
+
+        /**
+         * @return The cached segment, nullptr if it isn't ready (yet)
+         */
+        std::shared_ptr<const Segment> get(const std::string& name);
+
+        /**
+         * Number of frames stored in one ADPCM-block
+         */
+        static const size_t BLOCK_FRAMES = 1025;
+
+    private:
+        void workerFunction();
+
+        /**
+         * Renders the given segment and turns it into a loop
+         */
+        std::shared_ptr<Segment> render(const std::string& name);
+
+        std::shared_ptr<Segment> loadFromDisk(const std::string& name);
+        void saveToDisk(const std::string& name, const Segment& segment);
+        std::string getCacheFile(const std::string& name) const;
+
+        /**
+         * Puts the segment into the cache and drops the ones not used for the longest time
+         */
+        void store(const std::string& name, std::shared_ptr<const Segment> segment);
+
+        unsigned m_SampleRate;
+        unsigned m_Channels;
+        size_t m_LoopFrames;
+        std::string m_Directory;
+        Renderer m_Renderer;
+
+        std::mutex m_Mutex;
+        std::condition_variable m_Wakeup;
+
+        std::map<std::string, std::shared_ptr<const Segment>> m_Segments;
+
+        /**
+         * Names of the cached segments, most recently used first
+         */
+        std::list<std::string> m_RecentlyUsed;
+
+        std::deque<std::string> m_Queue;
+
+        /**
+         * Segments which failed to render. Not tried again.
+         */
+        std::set<std::string> m_Failed;
+
+        std::atomic<bool> m_Exiting;
+        std::thread m_Worker;
+    };
+}
@@ -378,10 +378,16 @@ namespace Components
 
         std::vector<Particle> m_Particles;
 
+        /**
+         * Frame of the PfxManager this system was last drawn in. Systems out of view don't need to be simulated.
+         */
+        uint32_t m_LastDrawnFrame;
+
         static void init(PfxComponent& c)
         {
             c.m_bgfxRenderState = BGFX_STATE_DEFAULT | BGFX_STATE_BLEND_ADD;
             c.m_ParticleVB.idx = BGFX_INVALID_HANDLE;
+            c.m_LastDrawnFrame = 0;
         }
     };
 
@@ -11,6 +11,7 @@
 #include <logic/PlayerController.h>
 #include <logic/SoundController.h>
 #include <logic/MusicController.h>
+#include <logic/NpcPool.h>
 #include <logic/mobs/Container.h>
 #include <logic/visuals/ModelVisual.h>
 #include <utils/logger.h>
@@ -39,9 +40,13 @@ Handle::EntityHandle VobTypes::initNPCFromScript(World::WorldInstance& world, Da
     Components::LogicComponent& logic = world.getEntity<Components::LogicComponent>(e);
     logic.m_pLogicController = new Logic::PlayerController(world, e, scriptInstance);
 
-    // Assign a default visual
-    Vob::VobInformation vob = Vob::asVob(world, e);
-    Vob::setVisual(vob, "HUM_BODY_NAKED0.MDM");
+    // The script constructor runs next. Its model might be found inside the NPC-pool, so the default visual
+    // is only assigned once the setup has ended without a pooled one.
+    if (!world.getNpcPool().beginSetup(e))
+    {
+        Vob::VobInformation vob = Vob::asVob(world, e);
+        Vob::setVisual(vob, "HUM_BODY_NAKED0.MDM");
+    }
 
     // FIXME: Debug, remove this
     Components::BBoxComponent& bbox = world.getEntity<Components::BBoxComponent>(e);
@@ -256,6 +261,17 @@ void ::VobTypes::NPC_SetModelVisual(VobTypes::NpcVobInformation& vob, const std:
     // Strip extension
     std::string libName = visual.substr(0, visual.find_last_of('.'));
 
+    // Only loaded once the body mesh is known, so a pooled shell can be used instead
+    if (vob.world->getNpcPool().deferModelScript(e, libName))
+        return;
+
+    // Shells from the NPC-pool already have this model loaded
+    if (anim.getAnimHandler().getMeshLibName() == libName)
+    {
+        vob.playerController->getNpcAnimationHandler().initAnimations();
+        return;
+    }
+
     anim.getAnimHandler().setWorld(*vob.world);
     anim.getAnimHandler().loadMeshLibFromVDF(libName, vob.world->getEngine()->getVDFSIndex());
 
@@ -303,6 +319,30 @@ void ::VobTypes::NPC_SetModelVisual(VobTypes::NpcVobInformation& vob, const std:
     //anim.getAnimHandler().playAnimation("S_RUNL");
 }
 
+void ::VobTypes::NPC_EndSetup(VobTypes::NpcVobInformation& vob, const std::string& bodyVisual)
+{
+    // Possibly moves the visual of a pooled shell over
+    std::string meshLib;
+    if (!vob.world->getNpcPool().endSetup(vob.entity, bodyVisual, meshLib))
+        return;
+
+    vob = VobTypes::asNpcVob(*vob.world, vob.entity);
+
+    if (!vob.visual)
+    {
+        Vob::VobInformation v = Vob::asVob(*vob.world, vob.entity);
+        Vob::setVisual(v, "HUM_BODY_NAKED0.MDM");
+
+        vob = VobTypes::asNpcVob(*vob.world, vob.entity);
+    }
+
+    if (!meshLib.empty())
+        NPC_SetModelVisual(vob, meshLib);
+
+    // Weapons equipped by the script before there was a model to attach them to
+    vob.playerController->undrawWeapon();
+}
+
 void ::VobTypes::NPC_SetHeadMesh(VobTypes::NpcVobInformation& vob, const std::string& visual, int headTextureIdx,
                                  int teethTextureIdx)
 {
@@ -314,13 +354,17 @@ void ::VobTypes::NPC_SetHeadMesh(VobTypes::NpcVobInformation& vob, const std::st
 
 void ::VobTypes::NPC_SetBodyMesh(VobTypes::NpcVobInformation& vob, const std::string& visual, int bodyTexIdx, int skinColorIdx)
 {
+    std::string bodyVisual = visual;
+
+    if (bodyVisual.find_first_of('.') == std::string::npos)
+        bodyVisual += ".MDM";
+
+    NPC_EndSetup(vob, bodyVisual);
+
     Logic::ModelVisual* model = reinterpret_cast<Logic::ModelVisual*>(vob.visual);
     Logic::ModelVisual::BodyState state = model->getBodyState();
 
-    state.bodyVisual = visual;
-
-    if (state.bodyVisual.find_first_of('.') == std::string::npos)
-        state.bodyVisual += ".MDM";
+    state.bodyVisual = bodyVisual;
 
     if (bodyTexIdx != -1)
         state.bodyTextureIdx = static_cast<int>(bodyTexIdx);
@@ -362,11 +406,9 @@ Handle::EntityHandle VobTypes::Wld_InsertNpc(World::WorldInstance& world, size_t
 
 Handle::EntityHandle VobTypes::Wld_InsertNpc(World::WorldInstance& world, const std::string& instanceName, const std::string& wpName)
 {
-    // Use script-engine to insert the NPC
-    Daedalus::GameState::NpcHandle npc = world.getScriptEngine().getGameState().insertNPC(instanceName, wpName);
+    size_t instanceSymbol = world.getScriptEngine().getVM().getDATFile().getSymbolIndexByName(instanceName);
 
-    // Get engine-side entity of the created npc
-    return getEntityFromScriptInstance(world, npc);
+    return Wld_InsertNpc(world, instanceSymbol, wpName);
 }
 
 Daedalus::GameState::ItemHandle VobTypes::NPC_DrawMeleeWeapon(VobTypes::NpcVobInformation& npc)
@@ -426,8 +468,11 @@ void VobTypes::Wld_RemoveNpc(World::WorldInstance& world, Handle::EntityHandle n
 {
     VobTypes::NpcVobInformation vob = VobTypes::asNpcVob(world, npc);
 
+    Daedalus::GameState::NpcHandle scriptHandle = vob.playerController->getScriptHandle();
+    bool isPlayer = npc == world.getScriptEngine().getPlayerEntity();
+
     // clear script variable "hero" and invalidate player entity
-    if (npc == world.getScriptEngine().getPlayerEntity())
+    if (isPlayer)
     {
         world.getScriptEngine().setPlayerEntity(Handle::EntityHandle::makeInvalidHandle());
         auto invalidHandle = Daedalus::GameState::NpcHandle();
@@ -435,6 +480,12 @@ void VobTypes::Wld_RemoveNpc(World::WorldInstance& world, Handle::EntityHandle n
     }
 
     world.getScriptEngine().unregisterNpc(npc);
-    world.getScriptEngine().getGameState().removeNPC(vob.playerController->getScriptHandle());
-    world.removeEntity(npc);
+
+    // Pooling needs the script instance, so do this before removing it
+    bool pooled = !isPlayer && world.getNpcPool().release(npc);
+
+    world.getScriptEngine().getGameState().removeNPC(scriptHandle);
+
+    if (!pooled)
+        world.removeEntity(npc);
 }
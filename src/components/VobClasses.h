@@ -137,6 +137,14 @@ namespace VobTypes
      */
     void NPC_SetHeadMesh(NpcVobInformation& vob, const std::string& visual, int headTextureIdx = 0, int teethTextureIdx = 0);
 
+    /**
+     * Ends the setup of an NPC inserted by script. Until then, it has no visual, so the one of a pooled shell
+     * can be taken over. Otherwise, the default visual is set. Does nothing if the NPC is not being set up.
+     * @param vob NPC to operate on. Re-fetched, as its visual changes.
+     * @param bodyVisual Body mesh set by the script, empty if it didn't set one
+     */
+    void NPC_EndSetup(NpcVobInformation& vob, const std::string& bodyVisual);
+
     /**
      * Sets the visual on the given NPCs model, without changing the body-state, like the headmesh
      * @param vob NPC to operate on
@@ -28,5 +28,5 @@ Components::CompoundComponent& Content::Wrap::getCompoundComponent(World::WorldI
 
 Handle::TextureHandle Content::Wrap::loadTextureVDF(World::WorldInstance& world, const std::string& file)
 {
-    return world.getTextureAllocator().loadTextureVDF(file);
+    return world.getTextureAllocator().loadTextureSequenceVDF(file);
 }
\ No newline at end of file
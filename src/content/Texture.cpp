@@ -1,12 +1,18 @@
 #include "Texture.h"
 #include <bgfx/bgfx.h>
 #include <engine/BaseEngine.h>
+#include <utils/Utils.h>
 #include <utils/logger.h>
 #include <vdfs/fileIndex.h>
 #include <zenload/ztex2dds.h>
 
 using namespace Textures;
 
+/**
+ * Upper limit when searching for the frames of an animated texture
+ */
+const size_t MAX_NUM_TEXTURE_ANIMATION_FRAMES = 64;
+
 // These are compiled inside bgfx
 typedef unsigned char stbi_uc;
 extern "C" stbi_uc* stbi_load_from_memory(stbi_uc const* _buffer, int _len, int* _x, int* _y, int* _comp, int _req_comp);
@@ -174,6 +180,40 @@ Handle::TextureHandle TextureAllocator::loadTextureVDF(const std::string& name)
     return loadTextureVDF(m_Engine.getVDFSIndex(), name);
 }
 
+Handle::TextureHandle TextureAllocator::loadTextureSequenceVDF(const std::string& name)
+{
+    // Frames only need to be searched once
+    bool alreadyLoaded = m_TexturesByName.find(name) != m_TexturesByName.end();
+
+    Handle::TextureHandle h = loadTextureVDF(name);
+    if (alreadyLoaded || !h.isValid())
+        return h;
+
+    // Animated textures are numbered like "WATER_A0.TGA", "WATER_A1.TGA", ...
+    size_t dot = name.find_last_of('.');
+    if (dot == std::string::npos || dot < 3 || Utils::toUpper(name.substr(dot - 3, 3)) != "_A0")
+        return h;
+
+    std::string base = name.substr(0, dot - 1);
+    std::string ext = name.substr(dot);
+
+    std::vector<Handle::TextureHandle> frames = {h};
+    for (size_t i = 1; i < MAX_NUM_TEXTURE_ANIMATION_FRAMES; i++)
+    {
+        Handle::TextureHandle frame = loadTextureVDF(base + std::to_string(i) + ext);
+
+        if (!frame.isValid())
+            break;
+
+        frames.push_back(frame);
+    }
+
+    if (frames.size() > 1)
+        m_Allocator.getElement(h).m_AnimationFrames = std::move(frames);
+
+    return h;
+}
+
 bool TextureAllocator::finalizeLoad(Handle::TextureHandle h)
 {
     Texture& tx = m_Allocator.getElement(h);
@@ -27,10 +27,20 @@ namespace Textures
         uint32_t m_Height;
         std::vector<uint8_t> imageData;
         bgfx::TextureFormat::Enum textureFormat;
+
+        /**
+         * Handles of all frames, if this is the first frame of an animated texture. Empty otherwise.
+         */
+        std::vector<Handle::TextureHandle> m_AnimationFrames;
     };
 
     typedef _Texture<Handle::InternalTextureHandle> Texture;
 
+    /**
+     * Playback-speed of animated textures
+     */
+    const double TEXTURE_ANIMATION_FPS = 16.0;
+
     class TextureAllocator
     {
     public:
@@ -49,6 +59,27 @@ namespace Textures
         Handle::TextureHandle loadTextureVDF(const VDFS::FileIndex& idx, const std::string& name);
         Handle::TextureHandle loadTextureVDF(const std::string& name);
 
+        /**
+         * @brief Like loadTextureVDF, but if the texture is the first frame of an animation (ie. "WATER_A0.TGA"),
+         *        all following frames are loaded as well and stored with the first one
+         */
+        Handle::TextureHandle loadTextureSequenceVDF(const std::string& name);
+
+        /**
+         * @param h Texture loaded via loadTextureSequenceVDF
+         * @param time Time in seconds
+         * @return Frame of the animation to display at the given time. h, if the texture is not animated.
+         */
+        Handle::TextureHandle getAnimationFrame(Handle::TextureHandle h, double time)
+        {
+            const std::vector<Handle::TextureHandle>& frames = m_Allocator.getElement(h).m_AnimationFrames;
+
+            if (frames.empty())
+                return h;
+
+            return frames[static_cast<size_t>(time * TEXTURE_ANIMATION_FPS) % frames.size()];
+        }
+
         /**
          * @brief Returns the texture of the given handle
          */
@@ -121,10 +121,17 @@ void BaseEngine::initEngine(int argc, char** argv)
     m_pFontCache = new UI::zFontCache(*this);
     m_pHUD = new UI::Hud(*this);
     getRootUIView().addChild(m_pHUD);
+
+    m_Metrics.init();
 }
 
-void BaseEngine::frameUpdate(double dt, uint16_t width, uint16_t height)
+void BaseEngine::frameUpdate(double dt, double workTime, uint16_t width, uint16_t height)
 {
+    // Waiting for the next frame isn't load the quality could be lowered for
+    m_QualityGovernor.onFrame(workTime);
+    m_Metrics.onFrame(*this, workTime);
+    m_Console.getScript().onFrame(dt);
+
     onFrameUpdate(dt * getGameClock().getGameEngineSpeedFactor(), width, height);
 }
 
@@ -2,6 +2,8 @@
 #include <future>
 #include "World.h"
 #include "JobManager.h"
+#include "MetricsServer.h"
+#include "QualityGovernor.h"
 #include <bx/commandline.h>
 #include <engine/GameClock.h>
 #include <engine/GameSession.h>
@@ -67,8 +69,10 @@ namespace Engine
         void setBasicGameType(Daedalus::GameType type) { m_BasicGameType = type; }
         /**
          * @brief Frame update // TODO: Remove width and height
+         * @param dt Time since the last frame
+         * @param workTime Part of dt not spent waiting for the frame to start
          */
-        void frameUpdate(double dt, uint16_t width, uint16_t m_height);
+        void frameUpdate(double dt, double workTime, uint16_t width, uint16_t m_height);
 
         /**
          * @return Main VDF-Archive
@@ -107,6 +111,17 @@ namespace Engine
          * @return Console
          */
         Logic::Console& getConsole() { return m_Console; }
+
+        /**
+         * @return Governor scaling detail-settings to hold the target frametime
+         */
+        QualityGovernor& getQualityGovernor() { return m_QualityGovernor; }
+
+        /**
+         * @return Counters and endpoint for external monitoring
+         */
+        MetricsServer& getMetrics() { return m_Metrics; }
+
         /**
          * @return Arguments passed to the engine
          */
@@ -160,6 +175,11 @@ namespace Engine
          */
         void togglePaused() { setPaused(!m_Paused); }
 
+        /**
+         * @return Whether the game is currently paused
+         */
+        bool isPaused() const { return m_Paused; }
+
         /**
          * Called when a world was added
          * TODO onWorld... should be protected, but currently need to call this function from GameSession
@@ -213,6 +233,16 @@ namespace Engine
          */
         Logic::Console m_Console;
 
+        /**
+         * Scales detail-settings by frametime
+         */
+        QualityGovernor m_QualityGovernor;
+
+        /**
+         * Serves engine-metrics to external tools
+         */
+        MetricsServer m_Metrics;
+
         /**
          * Arguments
          */
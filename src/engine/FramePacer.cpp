@@ -0,0 +1,124 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <utils/cli.h>
+
+using namespace Engine;
+
+namespace Flags
+{
+    Cli::Flag maxFps("", "max-fps", 1, "Upper limit for the framerate. 0 means unlimited.", {"0"}, "Rendering");
+    Cli::Flag idleFps("", "idle-fps", 1, "Framerate while the game is paused or in a menu. 0 means unlimited.", {"30"}, "Rendering");
+    Cli::Flag backgroundFps("", "background-fps", 1, "Framerate while the window is unfocused or minimized. 0 means unlimited.", {"10"}, "Rendering");
+}
+
+/**
+ * Length of a single sleep while waiting. Short enough to not overshoot by much, even on coarse schedulers.
+ */
+const std::chrono::milliseconds SLEEP_STEP(1);
+
+/**
+ * How many standard-deviations of the measured sleep-time to keep as safety-margin before spinning
+ */
+const double SLEEP_MARGIN_STDDEV = 1.0;
+
+/**
+ * Number of sleeps after which the estimate is reset, so it can follow changes of the scheduler
+ */
+const long MAX_NUM_SLEEP_SAMPLES = 1000;
+
+FramePacer::FramePacer()
+    : m_NextFrame(Clock::now())
+    , m_SleepMean(0.002)
+    , m_SleepM2(0.0)
+    , m_NumSleeps(1)
+    , m_TotalWaitTime(0.0)
+{
+    m_MaxFrameRate = std::max(0.0, atof(Flags::maxFps.getParam(0).c_str()));
+    m_IdleFrameRate = std::max(0.0, atof(Flags::idleFps.getParam(0).c_str()));
+    m_BackgroundFrameRate = std::max(0.0, atof(Flags::backgroundFps.getParam(0).c_str()));
+}
+
+double FramePacer::getTargetFrameRate(EActivity activity) const
+{
+    double rate = m_MaxFrameRate;
+
+    switch (activity)
+    {
+        case A_Idle:
+            rate = m_IdleFrameRate;
+            break;
+        case A_Background:
+            rate = m_BackgroundFrameRate;
+            break;
+        default:
+            break;
+    }
+
+    // Never run faster than the global limit
+    if (m_MaxFrameRate > 0.0 && (rate <= 0.0 || rate > m_MaxFrameRate))
+        rate = m_MaxFrameRate;
+
+    return rate;
+}
+
+double FramePacer::waitForNextFrame(EActivity activity)
+{
+    double rate = getTargetFrameRate(activity);
+    Clock::time_point now = Clock::now();
+
+    if (rate <= 0.0)
+    {
+        m_NextFrame = now;
+        return 0.0;
+    }
+
+    Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+
+    // Frames which took too long push the schedule back instead of being caught up with a burst
+    m_NextFrame = std::max(m_NextFrame + period, now);
+
+    // Don't keep waiting for a long frame when switching to a faster rate
+    m_NextFrame = std::min(m_NextFrame, now + period);
+
+    waitUntil(m_NextFrame);
+
+    double waited = std::chrono::duration<double>(Clock::now() - now).count();
+    m_TotalWaitTime += waited;
+
+    return waited;
+}
+
+void FramePacer::waitUntil(Clock::time_point deadline)
+{
+    while (true)
+    {
+        double remaining = std::chrono::duration<double>(deadline - Clock::now()).count();
+        double stddev = m_NumSleeps > 1 ? std::sqrt(m_SleepM2 / (m_NumSleeps - 1)) : 0.0;
+
+        if (remaining <= m_SleepMean + SLEEP_MARGIN_STDDEV * stddev)
+            break;
+
+        Clock::time_point start = Clock::now();
+        std::this_thread::sleep_for(SLEEP_STEP);
+        double slept = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (m_NumSleeps >= MAX_NUM_SLEEP_SAMPLES)
+        {
+            m_NumSleeps = 1;
+            m_SleepM2 = 0.0;
+        }
+
+        // Welford's online mean and variance
+        m_NumSleeps++;
+        double delta = slept - m_SleepMean;
+        m_SleepMean += delta / m_NumSleeps;
+        m_SleepM2 += delta * (slept - m_SleepMean);
+    }
+
+    // Spin for the rest
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
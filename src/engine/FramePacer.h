@@ -0,0 +1,79 @@
+#pragma once
+#include <chrono>
+
+namespace Engine
+{
+    /**
+     * Limits how often the main-loop runs by waiting for the start of the next frame.
+     * Sleeps for most of the wait and only spins for the last bit, which the OS-scheduler
+     * can't be trusted with. How long a sleep overshoots is measured while running.
+     *
+     * Target-rates are read from --max-fps, --idle-fps and --background-fps.
+     */
+    class FramePacer
+    {
+    public:
+        enum EActivity
+        {
+            /**
+             * Game is running and the window has focus
+             */
+            A_Active,
+
+            /**
+             * Game is paused or sitting in a menu
+             */
+            A_Idle,
+
+            /**
+             * Window is unfocused or minimized
+             */
+            A_Background
+        };
+
+        FramePacer();
+
+        /**
+         * Waits until the next frame should start
+         * @param activity What's currently going on. Selects the target-rate.
+         * @return Time spent waiting, in seconds
+         */
+        double waitForNextFrame(EActivity activity);
+
+        /**
+         * @return Total time spent waiting so far, in seconds
+         */
+        double getTotalWaitTime() const { return m_TotalWaitTime; }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        /**
+         * @return Target frames per second for the given activity. 0 means unlimited.
+         */
+        double getTargetFrameRate(EActivity activity) const;
+
+        /**
+         * Sleeps until shortly before the given point in time, then spins for the rest
+         */
+        void waitUntil(Clock::time_point deadline);
+
+        double m_MaxFrameRate;
+        double m_IdleFrameRate;
+        double m_BackgroundFrameRate;
+
+        /**
+         * Start of the next frame
+         */
+        Clock::time_point m_NextFrame;
+
+        /**
+         * Running estimate of how long a 1ms-sleep actually takes, in seconds (Welford)
+         */
+        double m_SleepMean;
+        double m_SleepM2;
+        long m_NumSleeps;
+
+        double m_TotalWaitTime;
+    };
+}
@@ -3,12 +3,18 @@
 //
 
 #include "GameEngine.h"
+#include <algorithm>
 #include <common.h>
 #include <bx/commandline.h>
 #include <components/EntityActions.h>
 #include <components/Vob.h>
+#include <components/VobClasses.h>
+#include <engine/TransformInterpolator.h>
 #include <entry/input.h>
 #include <logic/CameraController.h>
+#include <logic/PfxManager.h>
+#include <logic/PlayerController.h>
+#include <logic/ScriptEngine.h>
 #include <render/RenderSystem.h>
 #include <render/WorldRender.h>
 #include <utils/logger.h>
@@ -20,13 +26,25 @@ using namespace Engine;
 namespace Flags
 {
     Cli::Flag drawDistance("rdist", "render-distance", 1, "Renderdistance multiplicator", {"1"}, {"Rendering"});
+    Cli::Flag logicRate("", "logic-rate", 1, "Updates per second of game-logic, AI and physics. Rendering interpolates in between. 0 updates once per frame.", {"60"}, "Game");
 }
 
 const float DRAW_DISTANCE = 100.0f;
 
+/**
+ * Upper limit of logic-ticks done in a single frame. If frames take longer than that, the game slows down
+ * instead of spending even more time on catching up.
+ */
+const int MAX_LOGIC_TICKS_PER_FRAME = 8;
+
 GameEngine::GameEngine()
     : m_DefaultRenderSystem(*this)
+    , m_LogicTickLength(0.0)
+    , m_LogicTimeAccumulator(0.0)
 {
+    double rate = atof(Flags::logicRate.getParam(0).c_str());
+    if (rate > 0.0)
+        m_LogicTickLength = 1.0 / rate;
 }
 
 GameEngine::~GameEngine()
@@ -71,30 +89,97 @@ void GameEngine::onFrameUpdate(double dt, uint16_t width, uint16_t height)
 
     //        lastLogicDisableKeyState = inputGetKeyState(entry::Key::Key2);
     //    }
-    if (!getSession().getWorldInstances().empty())
+    if (getSession().getWorldInstances().empty())
     {
-        if (m_Paused)
-        {
-            getMainWorld().get().getCameraController()->onUpdate(dt);
-        }
-        else
-        {
-            // Get draw-distance from config
-            float drawDistanceMod = atof(Flags::drawDistance.getParam(0).c_str());
-            float drawDistanceTotal = DRAW_DISTANCE * drawDistanceMod;
-
-            getGameClock().update(dt);
-            for (auto& s : getSession().getWorldInstances())
-            {
-                // Update main-world after every other world, since the camera is in there
-                s->onFrameUpdate(dt, drawDistanceTotal * drawDistanceTotal, s->getCameraComp<Components::PositionComponent>().m_WorldMatrix);
-            }
-
-            // Finally, update main camera
-            getMainWorld().get().getCameraController()->onUpdateExplicit(dt);
-        }
+        drawFrame(width, height);
+        return;
+    }
+
+    // Particle-visibility is per rendered frame, no matter how many logic-ticks it takes
+    for (auto& s : getSession().getWorldInstances())
+        s->getPfxManager().onFrameStart();
+
+    if (m_Paused)
+    {
+        getMainWorld().get().getCameraController()->onUpdate(dt);
+        drawFrame(width, height);
+        return;
+    }
+
+    if (m_LogicTickLength <= 0.0)
+    {
+        updateLogic(dt);
+        resetPlayerInput();
+
+        // Finally, update main camera
+        getMainWorld().get().getCameraController()->onUpdateExplicit(dt);
+        drawFrame(width, height);
+        return;
+    }
+
+    m_LogicTimeAccumulator += dt;
+
+    int numTicks = 0;
+    while (m_LogicTimeAccumulator >= m_LogicTickLength && numTicks < MAX_LOGIC_TICKS_PER_FRAME)
+    {
+        for (auto& s : getSession().getWorldInstances())
+            s->getTransformInterpolator().beginTick();
+
+        updateLogic(m_LogicTickLength);
+
+        for (auto& s : getSession().getWorldInstances())
+            s->getTransformInterpolator().endTick();
+
+        m_LogicTimeAccumulator -= m_LogicTickLength;
+        numTicks++;
     }
+
+    // Bindings fire once per frame, so their input has to last for all ticks of it. Frames without a tick
+    // keep it for the next one.
+    if (numTicks > 0)
+        resetPlayerInput();
+
+    // Drop whatever we couldn't catch up with
+    m_LogicTimeAccumulator = std::min(m_LogicTimeAccumulator, m_LogicTickLength);
+
+    // Render in between the last two logic-states. The camera follows the blended positions.
+    float alpha = static_cast<float>(m_LogicTimeAccumulator / m_LogicTickLength);
+    for (auto& s : getSession().getWorldInstances())
+        s->getTransformInterpolator().apply(alpha);
+
+    getMainWorld().get().getCameraController()->onUpdateExplicit(dt);
     drawFrame(width, height);
+
+    for (auto& s : getSession().getWorldInstances())
+        s->getTransformInterpolator().restore();
+}
+
+void GameEngine::updateLogic(double dt)
+{
+    // Get draw-distance from config
+    float drawDistanceMod = atof(Flags::drawDistance.getParam(0).c_str());
+    float updateRange = DRAW_DISTANCE * drawDistanceMod * getQualityGovernor().getUpdateRangeScale();
+
+    getGameClock().update(dt);
+    for (auto& s : getSession().getWorldInstances())
+    {
+        // Update main-world after every other world, since the camera is in there
+        s->onFrameUpdate(dt, updateRange * updateRange, s->getCameraComp<Components::PositionComponent>().m_WorldMatrix);
+    }
+}
+
+void GameEngine::resetPlayerInput()
+{
+    for (auto& s : getSession().getWorldInstances())
+    {
+        Handle::EntityHandle e = s->getScriptEngine().getPlayerEntity();
+        if (!e.isValid())
+            continue;
+
+        VobTypes::NpcVobInformation player = VobTypes::asNpcVob(*s, e);
+        if (player.playerController)
+            player.playerController->resetKeyStates();
+    }
 }
 
 void GameEngine::drawFrame(uint16_t width, uint16_t height)
@@ -122,7 +207,7 @@ void GameEngine::drawFrame(uint16_t width, uint16_t height)
 
     // Get draw-distance from config
     float drawDistanceMod = atof(Flags::drawDistance.getParam(0).c_str());
-    float drawDistanceTotal = DRAW_DISTANCE * drawDistanceMod;
+    float drawDistanceTotal = DRAW_DISTANCE * drawDistanceMod * getQualityGovernor().getDrawDistanceScale();
 
     // Update the frame-config with the cameras world-matrix
     if (getMainWorld().isValid())
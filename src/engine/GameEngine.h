@@ -37,6 +37,17 @@ namespace Engine
          */
         void onFrameUpdate(double dt, uint16_t width, uint16_t height) override;
 
+        /**
+         * Runs one step of game-logic, AI and physics in all worlds
+         * @param dt Time to simulate, scaled by the game-speed
+         */
+        void updateLogic(double dt);
+
+        /**
+         * Clears the input the players got from the key-bindings this frame, once all logic-ticks have seen it
+         */
+        void resetPlayerInput();
+
         /**
          * Draws the worlds and presents the frame
          */
@@ -46,5 +57,15 @@ namespace Engine
          * Default rendering system
          */
         Render::RenderSystem m_DefaultRenderSystem;
+
+        /**
+         * Length of a logic-tick in seconds. 0 if logic runs once per frame.
+         */
+        double m_LogicTickLength;
+
+        /**
+         * Time which still has to be simulated
+         */
+        double m_LogicTimeAccumulator;
     };
 }
@@ -61,6 +61,14 @@ GameClock& GameSession::getGameClock()
     return m_GameClock;
 }
 
+void GameSession::resetProgress()
+{
+    m_InactiveWorlds.clear();
+    m_KnownInfos.clear();
+    m_LogManager.clear();
+    m_CurrentSlotIndex = -1;
+}
+
 void GameSession::removeAllWorlds()
 {
     while (!m_WorldInstances.empty())
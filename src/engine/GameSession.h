@@ -54,6 +54,12 @@ namespace Engine
          */
         GameClock& getGameClock();
 
+        /**
+         * Forgets everything the player did in this session (visited worlds, known infos, log),
+         * while keeping the loaded worlds alive. Used when a savegame is loaded into the current world.
+         */
+        void resetProgress();
+
         void setCurrentSlot(int index) { m_CurrentSlotIndex = index; }
         int getCurrentSlot() { return m_CurrentSlotIndex; }
 
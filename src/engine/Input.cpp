@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <utils/cli.h>
 #include "Input.h"
 
@@ -51,11 +52,15 @@ Action::Action(std::function<void(bool, float)> func)
 {
 }
 
-std::multimap<ActionBinding, int /* key */> Input::actionBindingToKeyMap;
-std::map<ActionBinding, int /*mouseButton*/> Input::actionBindingToMouseButtonMap;
-std::map<ActionBinding, Input::MouseAxis> Input::actionBindingToMouseAxisMap;
+std::vector<Input::InputBinding> Input::keyBindings;
+std::vector<Input::InputBinding> Input::mouseButtonBindings;
+std::vector<Input::InputBinding> Input::mouseAxisBindings;
+std::vector<std::vector<size_t>> Input::keyBindingsByKey(Input::NUM_KEYS);
+std::vector<size_t> Input::activeKeyBindings;
+std::vector<int> Input::changedKeys;
+std::bitset<Input::NUM_KEYS> Input::keyChanged;
 
-std::multimap<ActionType, Action> Input::actionTypeToActionMap;
+std::array<std::list<Action>, static_cast<size_t>(ActionType::Count)> Input::actionsByType;
 
 std::bitset<Input::NUM_KEYS> Input::keyState;
 std::bitset<Input::NUM_KEYS> Input::keyTriggered;
@@ -78,28 +83,28 @@ std::string Input::frameTextInput;
 
 ManagedActionBinding Input::RegisterAction(ActionType actionType, std::function<void(bool, float)> function)
 {
-    auto it = actionTypeToActionMap.insert(std::make_pair(actionType, Action(function)));
-    return {it->first, &it->second};
+    std::list<Action>& actions = actionsByType[static_cast<size_t>(actionType)];
+    actions.push_back(Action(function));
+    return {actionType, &actions.back()};
 }
 
 void Input::clearActions()
 {
-    actionTypeToActionMap.clear();
+    for (std::list<Action>& actions : actionsByType)
+        actions.clear();
 }
 
 bool Input::RemoveAction(ActionType actionType, Action* action)
 {
-    auto rangeIterators = actionTypeToActionMap.equal_range(actionType);
-    bool hasActionBeenFound = false;
-    for (auto it = rangeIterators.first; it != rangeIterators.second; ++it)
-        if (&((*it).second) == action)
+    std::list<Action>& actions = actionsByType[static_cast<size_t>(actionType)];
+    for (auto it = actions.begin(); it != actions.end(); ++it)
+        if (&(*it) == action)
         {
-            actionTypeToActionMap.erase(it);
-            hasActionBeenFound = true;
-            break;
+            actions.erase(it);
+            return true;
         }
 
-    return hasActionBeenFound;
+    return false;
 }
 
 Math::float2 Input::getMouseCoordinates()
@@ -109,24 +114,52 @@ Math::float2 Input::getMouseCoordinates()
 
 void Input::bindKey(int key, ActionType actionType, bool isContinuous, bool isInverted)
 {
-    actionBindingToKeyMap.emplace(ActionBinding(actionType, isContinuous, isInverted), key);
+    if (key < 0 || key >= Input::NUM_KEYS)
+        return;
+
+    keyBindingsByKey[key].push_back(keyBindings.size());
+    keyBindings.push_back({ActionBinding(actionType, isContinuous, isInverted), key, false});
+}
+
+/**
+ * Binds the given input to the binding, replacing the one bound to it before, if any
+ */
+template <typename T>
+static void bindUnique(std::vector<T>& bindings, const ActionBinding& binding, int input)
+{
+    for (T& b : bindings)
+    {
+        if (!(b.binding < binding) && !(binding < b.binding))
+        {
+            b.input = input;
+            return;
+        }
+    }
+
+    bindings.push_back({binding, input, false});
 }
 
 void Input::bindMouseButton(int mouseButton, ActionType actionType, bool isContinuous, bool isInverted)
 {
-    actionBindingToMouseButtonMap[ActionBinding(actionType, isContinuous, isInverted)] = mouseButton;
+    bindUnique(mouseButtonBindings, ActionBinding(actionType, isContinuous, isInverted), mouseButton);
 }
 
 void Input::bindMouseAxis(MouseAxis mouseAxis, ActionType actionType, bool isContinuous, bool isInverted)
 {
-    actionBindingToMouseAxisMap[ActionBinding(actionType, isContinuous, isInverted)] = mouseAxis;
+    bindUnique(mouseAxisBindings, ActionBinding(actionType, isContinuous, isInverted), static_cast<int>(mouseAxis));
 }
 
 void Input::keyEvent(int key, int scancode, int action, int mods)
 {
-    if (key < 0 || key > Input::NUM_KEYS)
+    if (key < 0 || key >= Input::NUM_KEYS)
         return;
 
+    if (!keyChanged[key])
+    {
+        keyChanged[key] = true;
+        changedKeys.push_back(key);
+    }
+
     if (KEY_ACTION_PRESS == action)
     {
         if(!keyState[key])
@@ -226,50 +259,77 @@ void Input::setMouseLockCallback(std::function<void(bool)> callback)
     mouseLockCallback = callback;
 }
 
+void Input::fireAction(ActionType actionType, bool triggered, float intensity)
+{
+    std::list<Action>& actions = actionsByType[static_cast<size_t>(actionType)];
+    for (auto it = actions.begin(); it != actions.end();)
+    {
+        // The action may remove itself
+        auto next = std::next(it);
+        if (it->isEnabled)
+            it->function(triggered, intensity);
+
+        it = next;
+    }
+}
+
+bool Input::updateBinding(InputBinding& binding, bool triggered)
+{
+    bool dispatch = triggered || binding.wasTriggered;
+    binding.wasTriggered = triggered;
+    return dispatch;
+}
+
 void Input::fireBindings()
 {
-    for (const auto itBindingToKey : actionBindingToKeyMap)
+    // Only bindings on keys which got an event or which were triggered last time can change their state.
+    // Everything else would just report "not triggered" again.
+    static std::vector<size_t> candidates;
+    candidates.assign(activeKeyBindings.begin(), activeKeyBindings.end());
+
+    for (int key : changedKeys)
+        candidates.insert(candidates.end(), keyBindingsByKey[key].begin(), keyBindingsByKey[key].end());
+
+    // Keep the order the bindings were made in
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    activeKeyBindings.clear();
+
+    for (size_t i : candidates)
     {
-        //                             is key currently pressed   AND ( is continuous                    OR key has just been triggered )
-        bool triggerAction = keyState.test(itBindingToKey.second) && (itBindingToKey.first.isContinuous || keyTriggered.test(itBindingToKey.second));
+        InputBinding& b = keyBindings[i];
+
+        //                             is key currently pressed   AND ( is continuous            OR key has just been triggered )
+        bool triggerAction = keyState.test(b.input) && (b.binding.isContinuous || keyTriggered.test(b.input));
         // Key causes a constant intensity of 1.0, when pressed.
         float intensity = triggerAction ? 1.0f : 0.0f;
         // Invert intensity if isInverted is true
-        intensity = itBindingToKey.first.isInverted ? -intensity : intensity;
+        intensity = b.binding.isInverted ? -intensity : intensity;
 
-        for (const auto& action : actionTypeToActionMap)
-        {
-            if (action.first == itBindingToKey.first.actionType && action.second.isEnabled)
-            {
-                action.second.function(triggerAction, intensity);
-            }
-        }
+        if (!updateBinding(b, triggerAction))
+            continue;
 
-        /*auto rangeIterators = actionTypeToActionMap.equal_range(itBindingToKey.first.actionType);
-        for(auto itAction = rangeIterators.first; itAction != rangeIterators.second; ++itAction)
-            if(itAction->second.isEnabled)
-            {
-                itAction->second.function(triggerAction, intensity);
-            }*/
+        if (triggerAction)
+            activeKeyBindings.push_back(i);
+
+        fireAction(b.binding.actionType, triggerAction, intensity);
     }
 
     clearTriggered();
 
     bool enableMouse = !Flags::disableMouse.isSet();
 
-    for (const auto itBindingToButton : actionBindingToMouseButtonMap)
+    for (InputBinding& b : mouseButtonBindings)
     {
-        bool triggerAction = mouseButtonState.test(itBindingToButton.second) && (itBindingToButton.first.isContinuous || mouseButtonTriggered.test(itBindingToButton.second));
+        bool triggerAction = mouseButtonState.test(b.input) && (b.binding.isContinuous || mouseButtonTriggered.test(b.input));
         // Button causes a constant intensity of 1.0 when pressed
         float intensity = triggerAction ? 1.0f : 0.0f;
         // Invert intensity if isInverted is true
-        intensity = itBindingToButton.first.isInverted ? -intensity : intensity;
-
-        auto rangeIterators = actionTypeToActionMap.equal_range(itBindingToButton.first.actionType);
-        for (auto itAction = rangeIterators.first; itAction != rangeIterators.second; ++itAction)
-            if (itAction->second.isEnabled && enableMouse)
-                itAction->second.function(triggerAction, intensity);
+        intensity = b.binding.isInverted ? -intensity : intensity;
 
+        if (updateBinding(b, triggerAction) && enableMouse)
+            fireAction(b.binding.actionType, triggerAction, intensity);
     }
     // This must be done after the loop, because multiple bindings to the same button may occur
     mouseButtonTriggered.reset();
@@ -281,15 +341,15 @@ void Input::fireBindings()
     mousePosition.x = axisPosition[static_cast<std::size_t>(MouseAxis::CursorX)];
     mousePosition.y = axisPosition[static_cast<std::size_t>(MouseAxis::CursorY)];
 
-    for (const auto itBindingToAxis : actionBindingToMouseAxisMap)
+    for (InputBinding& b : mouseAxisBindings)
     {
-        const size_t& mouseAxisIndex = static_cast<std::size_t>(itBindingToAxis.second);
-        bool triggerAction = mouseAxisState.test(mouseAxisIndex) && (itBindingToAxis.first.isContinuous || mouseAxisTriggered.test(mouseAxisIndex));
+        const size_t mouseAxisIndex = static_cast<std::size_t>(b.input);
+        bool triggerAction = mouseAxisState.test(mouseAxisIndex) && (b.binding.isContinuous || mouseAxisTriggered.test(mouseAxisIndex));
 
         // Special care for mouse coordinates must be taken. Since screen coordinates dont make too much sense
         // we are passing delta values of the mouse position.
         float intensity;
-        if (itBindingToAxis.second == MouseAxis::CursorX || itBindingToAxis.second == MouseAxis::CursorY)
+        if (mouseAxisIndex == static_cast<std::size_t>(MouseAxis::CursorX) || mouseAxisIndex == static_cast<std::size_t>(MouseAxis::CursorY))
         {
             // Mouse axis index is guaranteed to be either 0 or 1 due to the condition check above.
             intensity = mouseSensitivity * deltaMouse[mouseAxisIndex];
@@ -299,12 +359,10 @@ void Input::fireBindings()
             intensity = axisPosition[mouseAxisIndex];
 
         // Pass the axis position as intensity, caring for invertion
-        intensity = itBindingToAxis.first.isInverted ? -intensity : intensity;
+        intensity = b.binding.isInverted ? -intensity : intensity;
 
-        auto rangeIterators = actionTypeToActionMap.equal_range(itBindingToAxis.first.actionType);
-        for (auto itAction = rangeIterators.first; itAction != rangeIterators.second; ++itAction)
-            if (itAction->second.isEnabled && enableMouse)
-                itAction->second.function(triggerAction, intensity);
+        if (updateBinding(b, triggerAction) && enableMouse)
+            fireAction(b.binding.actionType, triggerAction, intensity);
     }
     // This must be done after the loop, because multiple bindings to the same axis may occur
     mouseAxisTriggered.reset();
@@ -333,12 +391,15 @@ void Input::getMouseState(Input::MouseState& ms)
 
 void Input::clearTriggered()
 {
-    // Reset all the keys, for text input
-    for (int i = 0; i < NUM_KEYS; i++)
+    // Reset all the keys, for text input. Only keys which got an event can have anything set.
+    for (int key : changedKeys)
     {
-        keyTriggered[i] = false;
-        modsTriggered[i] = 0;
+        keyTriggered[key] = false;
+        modsTriggered[key] = 0;
+        keyChanged[key] = false;
     }
+
+    changedKeys.clear();
 }
 
 std::string Input::getActualKeyName(int key)
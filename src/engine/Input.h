@@ -1,8 +1,10 @@
 #pragma once
+#include <array>
 #include <bitset>
 #include <cstdint>
 #include <cstring>
 #include <functional>
+#include <list>
 #include <map>
 #include <type_traits>
 #include <unordered_map>
@@ -217,11 +219,55 @@ namespace Engine
         static std::string frameTextInput;
 
     private:
-        static std::multimap<ActionBinding, int /* key */> actionBindingToKeyMap;
-        static std::map<ActionBinding, int /*mouseButton*/> actionBindingToMouseButtonMap;
-        static std::map<ActionBinding, MouseAxis> actionBindingToMouseAxisMap;
+        /**
+         * A key, mouse-button or mouse-axis bound to an action
+         */
+        struct InputBinding
+        {
+            ActionBinding binding;
+            int input;
+
+            /**
+             * Whether the action was fired as triggered on the last dispatch
+             */
+            bool wasTriggered;
+        };
+
+        /**
+         * Calls all enabled actions registered for the given type
+         */
+        static void fireAction(ActionType actionType, bool triggered, float intensity);
+
+        /**
+         * Bindings which are not triggered and weren't on the last dispatch either are idle and skipped
+         * @return Whether the binding needs to be dispatched
+         */
+        static bool updateBinding(InputBinding& binding, bool triggered);
+
+        static std::vector<InputBinding> keyBindings;
+        static std::vector<InputBinding> mouseButtonBindings;
+        static std::vector<InputBinding> mouseAxisBindings;
 
-        static std::multimap<ActionType, Action> actionTypeToActionMap;
+        /**
+         * Indices into keyBindings for every key
+         */
+        static std::vector<std::vector<size_t>> keyBindingsByKey;
+
+        /**
+         * Key-bindings which were triggered on the last dispatch
+         */
+        static std::vector<size_t> activeKeyBindings;
+
+        /**
+         * Keys which got an event since the last dispatch
+         */
+        static std::vector<int> changedKeys;
+        static std::bitset<NUM_KEYS> keyChanged;
+
+        /**
+         * Registered actions by type. Lists, so pointers to the actions stay valid.
+         */
+        static std::array<std::list<Action>, static_cast<size_t>(ActionType::Count)> actionsByType;
 
         static std::bitset<NUM_KEYS> keyState;
         static std::bitset<NUM_KEYS> keyTriggered;
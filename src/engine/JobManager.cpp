@@ -25,6 +25,18 @@ void JobManager::queueJob(JobType<void> job)
     m_JobQueue.push_back(std::move(job));
 }
 
+size_t JobManager::getNumQueuedJobs()
+{
+    std::lock_guard<std::recursive_mutex> guard(m_JobQueueMutex);
+    return m_JobQueue.size();
+}
+
+size_t JobManager::getNumAsyncJobs()
+{
+    std::lock_guard<std::mutex> lock(m_AsyncJobsMutex);
+    return m_AsyncJobs.size();
+}
+
 void JobManager::processJobs()
 {
     assert(isSameThread());
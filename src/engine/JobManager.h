@@ -46,6 +46,16 @@ public:
      */
     void processJobs();
 
+    /**
+     * @return Number of jobs waiting for processJobs()
+     */
+    size_t getNumQueuedJobs();
+
+    /**
+     * @return Number of jobs running asynchronously, which were not collected yet
+     */
+    size_t getNumAsyncJobs();
+
     /**
      * Executes the job in the specified thread
      * May be called from any thread
@@ -0,0 +1,226 @@
+#include "LightProbeGrid.h"
+#include "WorldMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utils/logger.h>
+
+using namespace World;
+
+/**
+ * Height of a cell. Horizontally, cells are at least MIN_CELL_SIZE_XZ wide, but get
+ * larger if the world would need more than MAX_NUM_COLUMNS otherwise.
+ */
+const float CELL_SIZE_Y = 1.0f;
+const float MIN_CELL_SIZE_XZ = 2.0f;
+const size_t MAX_NUM_COLUMNS = 1024 * 1024;
+
+/**
+ * How many cells above a surface still get lit by it. Old downward raytraces reached about as far.
+ */
+const int NUM_LAYERS_ABOVE_SURFACE = 8;
+
+namespace
+{
+    /**
+     * Point of a worldmesh-triangle found above the center of a column
+     */
+    struct SurfaceSample
+    {
+        uint32_t column;
+        float height;
+        float brightness;
+    };
+}
+
+LightProbeGrid::LightProbeGrid()
+    : m_CellSizeXZ(MIN_CELL_SIZE_XZ)
+    , m_NumX(0)
+    , m_NumZ(0)
+{
+}
+
+void LightProbeGrid::bake(const WorldMesh& mesh)
+{
+    m_Columns.clear();
+    m_Probes.clear();
+
+    const std::vector<Math::float3>& positions = mesh.getPositions();
+    const std::vector<uint32_t>& indices = mesh.getIndices();
+    const std::vector<uint32_t>& colors = mesh.getColors();
+
+    if (indices.empty())
+        return;
+
+    Math::float3 bmin = positions[0];
+    Math::float3 bmax = positions[0];
+    for (const Math::float3& p : positions)
+    {
+        bmin = Math::float3(std::min(bmin.x, p.x), std::min(bmin.y, p.y), std::min(bmin.z, p.z));
+        bmax = Math::float3(std::max(bmax.x, p.x), std::max(bmax.y, p.y), std::max(bmax.z, p.z));
+    }
+
+    float sizeX = bmax.x - bmin.x;
+    float sizeZ = bmax.z - bmin.z;
+
+    m_Origin = bmin;
+    m_CellSizeXZ = std::max(MIN_CELL_SIZE_XZ, std::sqrt(sizeX * sizeZ / MAX_NUM_COLUMNS));
+    m_NumX = static_cast<int>(sizeX / m_CellSizeXZ) + 1;
+    m_NumZ = static_cast<int>(sizeZ / m_CellSizeXZ) + 1;
+
+    auto layerOf = [&](float height) {
+        return static_cast<int>(std::floor((height - m_Origin.y) / CELL_SIZE_Y));
+    };
+
+    // Find all surfaces above the center of each column, like a vertical ray through it would
+    std::vector<SurfaceSample> samples;
+    for (size_t t = 0; t < indices.size(); t += 3)
+    {
+        const Math::float3& a = positions[indices[t + 0]];
+        const Math::float3& b = positions[indices[t + 1]];
+        const Math::float3& c = positions[indices[t + 2]];
+
+        // Barycentrics on the XZ-plane. Walls can't be hit from above.
+        float det = (b.z - c.z) * (a.x - c.x) + (c.x - b.x) * (a.z - c.z);
+        if (std::abs(det) < 1e-6f)
+            continue;
+
+        Math::float4 ca, cb, cc;
+        ca.fromABGR8(colors[indices[t + 0]]);
+        cb.fromABGR8(colors[indices[t + 1]]);
+        cc.fromABGR8(colors[indices[t + 2]]);
+
+        int x0 = std::max(0, static_cast<int>((std::min({a.x, b.x, c.x}) - m_Origin.x) / m_CellSizeXZ));
+        int x1 = std::min(m_NumX - 1, static_cast<int>((std::max({a.x, b.x, c.x}) - m_Origin.x) / m_CellSizeXZ));
+        int z0 = std::max(0, static_cast<int>((std::min({a.z, b.z, c.z}) - m_Origin.z) / m_CellSizeXZ));
+        int z1 = std::min(m_NumZ - 1, static_cast<int>((std::max({a.z, b.z, c.z}) - m_Origin.z) / m_CellSizeXZ));
+
+        for (int z = z0; z <= z1; z++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                float px = m_Origin.x + (x + 0.5f) * m_CellSizeXZ;
+                float pz = m_Origin.z + (z + 0.5f) * m_CellSizeXZ;
+
+                float u = ((b.z - c.z) * (px - c.x) + (c.x - b.x) * (pz - c.z)) / det;
+                float v = ((c.z - a.z) * (px - c.x) + (a.x - c.x) * (pz - c.z)) / det;
+                float w = 1.0f - u - v;
+
+                if (u < 0.0f || v < 0.0f || w < 0.0f)
+                    continue;
+
+                SurfaceSample s;
+                s.column = static_cast<uint32_t>(x + z * m_NumX);
+                s.height = u * a.y + v * b.y + w * c.y;
+                s.brightness = u * ca.x + v * cb.x + w * cc.x;  // Lighting is greyscale only
+                samples.push_back(s);
+            }
+        }
+    }
+
+    std::sort(samples.begin(), samples.end(), [](const SurfaceSample& l, const SurfaceSample& r) {
+        return l.column != r.column ? l.column < r.column : l.height < r.height;
+    });
+
+    m_Columns.assign(static_cast<size_t>(m_NumX) * m_NumZ, Column{0, 0, 0});
+
+    // Every surface lights the cells above it, up to the next surface
+    size_t i = 0;
+    while (i < samples.size())
+    {
+        size_t end = i;
+        while (end < samples.size() && samples[end].column == samples[i].column)
+            end++;
+
+        int first = layerOf(samples[i].height);
+        int last = std::min(static_cast<int>(std::numeric_limits<int16_t>::max()),
+                            layerOf(samples[end - 1].height) + NUM_LAYERS_ABOVE_SURFACE);
+
+        Column& column = m_Columns[samples[i].column];
+        column.offset = static_cast<uint32_t>(m_Probes.size());
+        column.firstLayer = static_cast<int16_t>(first);
+        column.numLayers = static_cast<uint16_t>(last - first + 1);
+
+        m_Probes.resize(m_Probes.size() + column.numLayers, 0);
+
+        for (size_t s = i; s < end; s++)
+        {
+            int from = layerOf(samples[s].height);
+            int to = std::min(last, from + NUM_LAYERS_ABOVE_SURFACE);
+
+            if (s + 1 < end)
+                to = std::min(to, layerOf(samples[s + 1].height) - 1);
+
+            float brightness = std::min(1.0f, std::max(0.0f, samples[s].brightness));
+            uint8_t value = static_cast<uint8_t>(1 + static_cast<int>(brightness * 254.0f + 0.5f));
+
+            for (int l = from; l <= to; l++)
+                m_Probes[column.offset + l - first] = value;
+        }
+
+        i = end;
+    }
+
+    LogInfo() << "Baked " << m_Probes.size() << " lighting-probes (" << m_NumX << "x" << m_NumZ << " columns, "
+              << m_CellSizeXZ << "m)";
+}
+
+uint8_t LightProbeGrid::getProbe(int x, int y, int z) const
+{
+    if (x < 0 || z < 0 || x >= m_NumX || z >= m_NumZ)
+        return 0;
+
+    const Column& column = m_Columns[x + z * m_NumX];
+
+    int layer = y - column.firstLayer;
+    if (layer < 0 || layer >= column.numLayers)
+        return 0;
+
+    return m_Probes[column.offset + layer];
+}
+
+float LightProbeGrid::sample(const Math::float3& position, float fallback) const
+{
+    if (m_Columns.empty())
+        return fallback;
+
+    // Probes sit at the cell-centers
+    float fx = (position.x - m_Origin.x) / m_CellSizeXZ - 0.5f;
+    float fy = (position.y - m_Origin.y) / CELL_SIZE_Y - 0.5f;
+    float fz = (position.z - m_Origin.z) / m_CellSizeXZ - 0.5f;
+
+    int x0 = static_cast<int>(std::floor(fx));
+    int y0 = static_cast<int>(std::floor(fy));
+    int z0 = static_cast<int>(std::floor(fz));
+
+    float tx = fx - x0;
+    float ty = fy - y0;
+    float tz = fz - z0;
+
+    // Trilinear interpolation, leaving out the corners without a probe
+    float sum = 0.0f;
+    float weight = 0.0f;
+    for (int i = 0; i < 8; i++)
+    {
+        int dx = i & 1;
+        int dy = (i >> 1) & 1;
+        int dz = (i >> 2) & 1;
+
+        uint8_t value = getProbe(x0 + dx, y0 + dy, z0 + dz);
+        if (!value)
+            continue;
+
+        float w = (dx ? tx : 1.0f - tx) * (dy ? ty : 1.0f - ty) * (dz ? tz : 1.0f - tz);
+        sum += w * (value - 1) / 254.0f;
+        weight += w;
+    }
+
+    if (weight > 0.0f)
+        return sum / weight;
+
+    uint8_t value = getProbe(static_cast<int>(std::floor(fx + 0.5f)),
+                             static_cast<int>(std::floor(fy + 0.5f)),
+                             static_cast<int>(std::floor(fz + 0.5f)));
+
+    return value ? (value - 1) / 254.0f : fallback;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <math/mathlib.h>
+
+namespace World
+{
+    class WorldMesh;
+
+    /**
+     * Sparse 3D-grid of lighting-probes, baked from the vertex-lighting of the worldmesh.
+     * Every probe holds the brightness of the closest surface below it, which is what a downward
+     * raytrace into the worldmesh would return. Dynamic objects sample this by position instead.
+     *
+     * The grid is stored as columns on the XZ-plane. Each column only holds the vertical range of
+     * cells which actually have a surface below them, everything else is left out.
+     */
+    class LightProbeGrid
+    {
+    public:
+        LightProbeGrid();
+
+        /**
+         * Builds the grid from the triangles and vertex-colors of the given worldmesh
+         */
+        void bake(const WorldMesh& mesh);
+
+        /**
+         * Interpolates the brightness at the given position from the surrounding probes
+         * @param position Position in world-coords
+         * @param fallback Value to return if there are no probes around the position
+         * @return Brightness in [0, 1]
+         */
+        float sample(const Math::float3& position, float fallback = 0.6f) const;
+
+        /**
+         * @return Number of probes stored
+         */
+        size_t getNumProbes() const { return m_Probes.size(); }
+
+    private:
+        struct Column
+        {
+            /**
+             * Index of the first probe inside m_Probes
+             */
+            uint32_t offset;
+
+            /**
+             * Vertical cell-index of the first probe and number of probes in this column
+             */
+            int16_t firstLayer;
+            uint16_t numLayers;
+        };
+
+        /**
+         * @return Stored brightness at the given cell, 0 if there is no probe. Otherwise in [1, 255].
+         */
+        uint8_t getProbe(int x, int y, int z) const;
+
+        Math::float3 m_Origin;
+        float m_CellSizeXZ;
+        int m_NumX;
+        int m_NumZ;
+
+        std::vector<Column> m_Columns;
+        std::vector<uint8_t> m_Probes;
+    };
+}
@@ -0,0 +1,199 @@
+#include "LooseItems.h"
+#include <algorithm>
+#include <components/Vob.h>
+#include <components/VobClasses.h>
+#include <content/ContentLoad.h>
+#include <content/StaticMeshAllocator.h>
+#include <engine/LightProbeGrid.h>
+#include <engine/World.h>
+#include <logic/ScriptEngine.h>
+#include <logic/VisualController.h>
+#include <utils/cli.h>
+
+using namespace World;
+
+namespace Flags
+{
+    Cli::Flag looseItems("", "loose-items", 1,
+                         "Keep items lying in the world as lightweight records until the player reaches for them. 0 disables.",
+                         {"1"}, "Game");
+}
+
+/**
+ * Invalid visual-index, for visuals which can't be drawn as loose item
+ */
+const uint32_t NO_VISUAL = static_cast<uint32_t>(-1);
+
+LooseItems::LooseItems(WorldInstance& world)
+    : m_World(world)
+{
+    m_Enabled = atoi(Flags::looseItems.getParam(0).c_str()) != 0;
+}
+
+bool LooseItems::addVob(const ZenLoad::zCVobData& v)
+{
+    if (!isEnabled() || v.objectClass != "oCItem:zCVob")
+        return false;
+
+    // Named vobs may be referenced by scripts. Let the usual path report invalid instances.
+    if (!v.vobName.empty() || !m_World.getScriptEngine().hasSymbol(v.oCItem.instanceName))
+        return false;
+
+    Math::Matrix transform = Math::Matrix(v.worldMatrix.mv);
+    transform.Translation(transform.Translation() * (1.0f / 100.0f));
+
+    return addRecord(m_World.getScriptEngine().getSymbolIndexByName(v.oCItem.instanceName), v.visual, transform);
+}
+
+bool LooseItems::addVob(const json& j)
+{
+    if (!isEnabled() || j.find("logic") == j.end() || j.find("visual") == j.end())
+        return false;
+
+    if (j["logic"]["type"] != "ItemController")
+        return false;
+
+    const json& jtrans = j["visual"]["transform"];
+
+    Math::Matrix transform = Math::Matrix::CreateIdentity();
+    for (int i = 0; i < 16; i++)
+        if (!jtrans[i].is_null())
+            transform.mv[i] = jtrans[i];
+
+    return addRecord(j["logic"]["instanceSymbol"].get<size_t>(), j["visual"]["name"].get<std::string>(), transform);
+}
+
+bool LooseItems::addItem(size_t instanceSymbol, const Math::Matrix& transform)
+{
+    if (!isEnabled())
+        return false;
+
+    // Only the visual is needed, which never differs from the prototype
+    const std::string& visual = m_World.getScriptEngine().getItemPrototype(instanceSymbol).visual;
+
+    return addRecord(instanceSymbol, visual, transform);
+}
+
+bool LooseItems::addRecord(size_t instanceSymbol, const std::string& visual, const Math::Matrix& transform)
+{
+    uint32_t visualIdx = findVisual(visual);
+
+    if (visualIdx == NO_VISUAL)
+        return false;
+
+    ItemRecord record;
+    record.transform = transform;
+    record.instanceSymbol = instanceSymbol;
+    record.visual = visualIdx;
+    record.shadow = m_World.getLightProbeGrid().sample(transform.Translation());
+
+    m_Items.push_back(record);
+    return true;
+}
+
+uint32_t LooseItems::findVisual(const std::string& name)
+{
+    std::string visual = name;
+    std::transform(visual.begin(), visual.end(), visual.begin(), ::toupper);
+
+    auto it = m_VisualsByName.find(visual);
+    if (it != m_VisualsByName.end())
+        return it->second;
+
+    // Only plain static meshes, everything else needs its visual-controller to work
+    uint32_t idx = NO_VISUAL;
+    if (visual.find(".3DS") != std::string::npos)
+    {
+        Handle::MeshHandle mesh = m_World.getStaticMeshAllocator().loadMeshVDF(visual);
+
+        if (mesh.isValid())
+        {
+            Meshes::WorldStaticMesh& mdata = m_World.getStaticMeshAllocator().getMesh(mesh);
+
+            ItemVisual v;
+            v.name = visual;
+            v.mesh = mesh;
+
+            for (const std::string& material : mdata.mesh.m_SubmeshMaterialNames)
+                v.textures.push_back(Content::Wrap::loadTextureVDF(m_World, material));
+
+            // Same as for any other vob
+            v.drawDistanceFactor = std::max(0.12f, std::min(1.0f, (mdata.bBox3D.max - mdata.bBox3D.min).length() / 10.0f));
+#ifdef ANDROID
+            v.drawDistanceFactor *= 0.6f;
+#endif
+
+            idx = static_cast<uint32_t>(m_Visuals.size());
+            m_Visuals.push_back(v);
+        }
+    }
+
+    m_VisualsByName[visual] = idx;
+    return idx;
+}
+
+void LooseItems::promoteInRadius(const Math::float3& center, float radius)
+{
+    // Backwards, since promoting moves the last item into the freed slot
+    for (size_t i = m_Items.size(); i > 0; i--)
+    {
+        if ((m_Items[i - 1].transform.Translation() - center).lengthSquared() <= radius * radius)
+            promote(i - 1);
+    }
+}
+
+Handle::EntityHandle LooseItems::promote(size_t idx)
+{
+    ItemRecord record = m_Items[idx];
+
+    m_Items[idx] = m_Items.back();
+    m_Items.pop_back();
+
+    Handle::EntityHandle e = VobTypes::createItem(m_World, record.instanceSymbol);
+
+    if (!e.isValid())
+        return e;
+
+    Meshes::WorldStaticMesh& mdata = m_World.getStaticMeshAllocator().getMesh(m_Visuals[record.visual].mesh);
+
+    Vob::VobInformation vob = Vob::asVob(m_World, e);
+    Vob::setTransform(vob, record.transform);
+    Vob::setBBox(vob, mdata.bBox3D.min, mdata.bBox3D.max, 0);
+
+    vob.position->m_DrawDistanceFactor = m_Visuals[record.visual].drawDistanceFactor;
+
+    if (vob.visual)
+        vob.visual->setShadowValue(record.shadow);
+
+    return e;
+}
+
+void LooseItems::exportRecords(json& controllers)
+{
+    for (const ItemRecord& r : m_Items)
+    {
+        // Write what an export of the actual item would look like
+        json j;
+
+        json& jvisual = j["visual"];
+        jvisual["type"] = "VisualController";
+        jvisual["name"] = m_Visuals[r.visual].name;
+        jvisual["collision"] = false;
+
+        for (int i = 0; i < 16; i++)
+            jvisual["transform"].push_back(r.transform.mv[i]);
+
+        json& jlogic = j["logic"];
+        jlogic["type"] = "ItemController";
+        jlogic["instanceSymbol"] = r.instanceSymbol;
+        jlogic["collision"] = false;
+        jlogic["transform"] = jvisual["transform"];
+
+        controllers.push_back(j);
+    }
+}
+
+void LooseItems::clear()
+{
+    m_Items.clear();
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <handle/HandleDef.h>
+#include <json.hpp>
+#include <math/mathlib.h>
+#include <zenload/zTypes.h>
+
+using json = nlohmann::json;
+
+namespace World
+{
+    class WorldInstance;
+
+    /**
+     * Items lying around in the world, which nobody has reached for yet.
+     * Those are only stored as position and script-instance and get drawn straight from the shared mesh of their
+     * visual. An item is turned into a full entity (see VobTypes::createItem) once the player tries to interact with it.
+     */
+    class LooseItems
+    {
+    public:
+        /**
+         * Mesh shared by all loose items using the same visual
+         */
+        struct ItemVisual
+        {
+            std::string name;
+            Handle::MeshHandle mesh;
+
+            /**
+             * Diffuse texture of each submesh
+             */
+            std::vector<Handle::TextureHandle> textures;
+
+            /**
+             * Same as PositionComponent::m_DrawDistanceFactor
+             */
+            float drawDistanceFactor;
+        };
+
+        struct ItemRecord
+        {
+            Math::Matrix transform;
+            size_t instanceSymbol;
+
+            /**
+             * Index of the visual, see getVisual()
+             */
+            uint32_t visual;
+
+            /**
+             * Shadow-value sampled from the worldmesh
+             */
+            float shadow;
+        };
+
+        LooseItems(WorldInstance& world);
+
+        /**
+         * @return Whether loose items are enabled for this world (see --loose-items)
+         */
+        bool isEnabled() const { return m_Enabled; }
+
+        /**
+         * Tries to store the given item-vob from a ZEN-file as loose item
+         * @return Whether the vob was taken. If false, it must be created as usual.
+         */
+        bool addVob(const ZenLoad::zCVobData& v);
+
+        /**
+         * Tries to store the given item from a savegame as loose item
+         * @return Whether the vob was taken. If false, it must be imported as usual.
+         */
+        bool addVob(const json& j);
+
+        /**
+         * Tries to store a freshly inserted item as loose item
+         * @param instanceSymbol Script-instance of the item
+         * @param transform World-transform of the item
+         * @return Whether the item was taken. If false, it must be created as usual.
+         */
+        bool addItem(size_t instanceSymbol, const Math::Matrix& transform);
+
+        /**
+         * Turns all loose items inside the given radius into full item-entities
+         * @param center Center of the sphere to search in
+         * @param radius Radius of the sphere in meters
+         */
+        void promoteInRadius(const Math::float3& center, float radius);
+
+        /**
+         * Writes all loose items into the given array, using the same format as WorldInstance::exportControllers,
+         * so they can be read by WorldInstance::importSingleVob
+         * @param controllers json-array to append to
+         */
+        void exportRecords(json& controllers);
+
+        /**
+         * Drops all loose items
+         */
+        void clear();
+
+        /**
+         * @return All loose items and their visuals, for rendering
+         */
+        const std::vector<ItemRecord>& getItems() const { return m_Items; }
+        const ItemVisual& getVisual(uint32_t idx) const { return m_Visuals[idx]; }
+
+    private:
+        /**
+         * Stores the given item, if its visual is a plain static mesh
+         * @return Whether the item was taken
+         */
+        bool addRecord(size_t instanceSymbol, const std::string& visual, const Math::Matrix& transform);
+
+        /**
+         * @return Index of the visual with the given name, loading it if needed. (uint32_t)-1 if the visual can't be
+         *         drawn as loose item.
+         */
+        uint32_t findVisual(const std::string& name);
+
+        /**
+         * @return Entity created from the item at the given index. The item is removed from the list.
+         */
+        Handle::EntityHandle promote(size_t idx);
+
+        std::vector<ItemRecord> m_Items;
+        std::vector<ItemVisual> m_Visuals;
+
+        /**
+         * Visual-indices by name. Visuals which failed to load map to (uint32_t)-1.
+         */
+        std::unordered_map<std::string, uint32_t> m_VisualsByName;
+
+        bool m_Enabled;
+
+        WorldInstance& m_World;
+    };
+}
@@ -0,0 +1,390 @@
+#include "MetricsServer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include "BaseEngine.h"
+#include <components/Entities.h>
+#include <content/SkeletalMeshAllocator.h>
+#include <content/StaticMeshAllocator.h>
+#include <content/Texture.h>
+#include <engine/LooseItems.h>
+#include <engine/RouteCache.h>
+#include <engine/VobStreamer.h>
+#include <engine/World.h>
+#include <logic/NpcPool.h>
+#include <logic/PfxManager.h>
+#include <logic/ProjectileManager.h>
+#include <utils/cli.h>
+#include <utils/logger.h>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define RE_METRICS_SUPPORTED
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Don't get killed by SIGPIPE if the client went away
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+using namespace Engine;
+
+namespace Flags
+{
+    Cli::Flag metricsPort("", "metrics-port", 1, "Serves engine-metrics on localhost at the given TCP-port, for monitoring. 0 disables this.", {"0"}, "Debug");
+    Cli::Flag metricsSocket("", "metrics-socket", 1, "Serves engine-metrics on the given Unix-socket instead of a TCP-port", {""}, "Debug");
+}
+
+/**
+ * Requests which didn't complete within this time are dropped
+ */
+const float CLIENT_TIMEOUT = 2.0f;
+
+/**
+ * Maximum size of a request we are willing to buffer
+ */
+const size_t MAX_REQUEST_SIZE = 4096;
+
+MetricsServer::MetricsServer()
+    : m_FrameTimeBounds({0.004, 0.008, 0.0167, 0.0333, 0.05, 0.1, 0.25, 0.5, 1.0})
+    , m_FrameTimeSum(0.0)
+    , m_FrameTimeCount(0)
+    , m_ListenSocket(-1)
+{
+    m_FrameTimeBuckets.resize(m_FrameTimeBounds.size() + 1, 0);
+
+    for (auto& c : m_Counters)
+        c = 0;
+}
+
+MetricsServer::~MetricsServer()
+{
+    for (Client& c : m_Clients)
+        closeSocket(c.socket);
+
+    if (m_ListenSocket >= 0)
+        closeSocket(m_ListenSocket);
+
+#ifdef RE_METRICS_SUPPORTED
+    if (!m_UnixSocketPath.empty())
+        unlink(m_UnixSocketPath.c_str());
+#endif
+}
+
+void MetricsServer::init()
+{
+    int port = atoi(Flags::metricsPort.getParam(0).c_str());
+    std::string path = Flags::metricsSocket.getParam(0);
+
+    if (port <= 0 && path.empty())
+        return;
+
+#ifdef RE_METRICS_SUPPORTED
+    int s;
+    if (!path.empty())
+    {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+
+        if (path.size() >= sizeof(addr.sun_path))
+        {
+            LogWarn() << "Metrics: Socket-path too long: " << path;
+            return;
+        }
+
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        // Left over from an earlier run
+        unlink(path.c_str());
+
+        s = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (s < 0 || bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        {
+            LogWarn() << "Metrics: Failed to bind to " << path;
+            if (s >= 0)
+                closeSocket(s);
+            return;
+        }
+
+        m_UnixSocketPath = path;
+    }
+    else
+    {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);  // Never expose this to the network
+
+        s = socket(AF_INET, SOCK_STREAM, 0);
+
+        int reuse = 1;
+        if (s >= 0)
+            setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if (s < 0 || bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        {
+            LogWarn() << "Metrics: Failed to bind to port " << port;
+            if (s >= 0)
+                closeSocket(s);
+            return;
+        }
+    }
+
+    if (listen(s, 8) != 0 || fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) != 0)
+    {
+        LogWarn() << "Metrics: Failed to listen";
+        closeSocket(s);
+        return;
+    }
+
+    m_ListenSocket = s;
+
+    if (!m_UnixSocketPath.empty())
+        LogInfo() << "Metrics: Serving on " << m_UnixSocketPath;
+    else
+        LogInfo() << "Metrics: Serving on http://127.0.0.1:" << port << "/metrics";
+#else
+    LogWarn() << "Metrics: Not supported on this platform";
+#endif
+}
+
+void MetricsServer::onFrame(BaseEngine& engine, double dt)
+{
+    if (!isEnabled())
+        return;
+
+    m_Counters[C_Frames]++;
+
+    size_t bucket = 0;
+    while (bucket < m_FrameTimeBounds.size() && dt > m_FrameTimeBounds[bucket])
+        bucket++;
+
+    m_FrameTimeBuckets[bucket]++;
+    m_FrameTimeSum += dt;
+    m_FrameTimeCount++;
+
+    acceptClients();
+    updateClients(engine, static_cast<float>(dt));
+}
+
+void MetricsServer::acceptClients()
+{
+#ifdef RE_METRICS_SUPPORTED
+    int c;
+    while ((c = accept(m_ListenSocket, nullptr, nullptr)) >= 0)
+    {
+        fcntl(c, F_SETFL, fcntl(c, F_GETFL, 0) | O_NONBLOCK);
+        m_Clients.push_back({c, "", 0.0f});
+    }
+#endif
+}
+
+void MetricsServer::updateClients(BaseEngine& engine, float dt)
+{
+#ifdef RE_METRICS_SUPPORTED
+    for (size_t i = 0; i < m_Clients.size();)
+    {
+        Client& client = m_Clients[i];
+        client.age += dt;
+
+        char buffer[512];
+        ssize_t n;
+        bool closed = false;
+        while ((n = recv(client.socket, buffer, sizeof(buffer), 0)) > 0)
+            client.request.append(buffer, static_cast<size_t>(n));
+
+        if (n == 0)
+            closed = true;
+
+        // Wait for the end of the header. Also answer plain socket-clients, which may just close their side.
+        bool complete = client.request.find("\r\n\r\n") != std::string::npos || client.request.find("\n\n") != std::string::npos;
+
+        if (complete || closed || client.request.size() > MAX_REQUEST_SIZE)
+        {
+            std::string body = buildReport(engine);
+
+            std::stringstream response;
+            response << "HTTP/1.0 200 OK\r\n"
+                     << "Content-Type: text/plain; version=0.0.4\r\n"
+                     << "Content-Length: " << body.size() << "\r\n"
+                     << "Connection: close\r\n\r\n"
+                     << body;
+
+            // Responses are small, so block until everything is out
+            std::string out = response.str();
+            fcntl(client.socket, F_SETFL, fcntl(client.socket, F_GETFL, 0) & ~O_NONBLOCK);
+            size_t sent = 0;
+            while (sent < out.size())
+            {
+                ssize_t r = send(client.socket, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+                if (r <= 0)
+                    break;
+
+                sent += static_cast<size_t>(r);
+            }
+
+            shutdown(client.socket, SHUT_RDWR);
+            closed = true;
+        }
+        else if (client.age > CLIENT_TIMEOUT)
+        {
+            closed = true;
+        }
+
+        if (closed)
+        {
+            closeSocket(client.socket);
+            m_Clients[i] = m_Clients.back();
+            m_Clients.pop_back();
+        }
+        else
+        {
+            i++;
+        }
+    }
+#endif
+}
+
+void MetricsServer::closeSocket(int socket)
+{
+#ifdef RE_METRICS_SUPPORTED
+    close(socket);
+#endif
+}
+
+std::string MetricsServer::buildReport(BaseEngine& engine)
+{
+    std::stringstream ss;
+
+    auto counter = [&](const char* name, const char* help, uint64_t value) {
+        ss << "# HELP " << name << " " << help << "\n"
+           << "# TYPE " << name << " counter\n"
+           << name << " " << value << "\n";
+    };
+
+    auto gauge = [&](const char* name, const char* help) {
+        ss << "# HELP " << name << " " << help << "\n"
+           << "# TYPE " << name << " gauge\n";
+    };
+
+    counter("regoth_frames_total", "Frames rendered", m_Counters[C_Frames]);
+    counter("regoth_physics_raytraces_total", "Raytraces done by the physics-system", m_Counters[C_PhysicsRaytraces]);
+    counter("regoth_physics_sweeps_total", "Convex sweeps done by character-controllers", m_Counters[C_PhysicsSweeps]);
+    counter("regoth_script_calls_total", "Script-functions called from the engine", m_Counters[C_ScriptCalls]);
+
+    // Sums up all threads of the process, which is what soak-runs compare
+    ss << "# HELP regoth_process_cpu_seconds_total CPU-time used by the process\n"
+       << "# TYPE regoth_process_cpu_seconds_total counter\n"
+       << "regoth_process_cpu_seconds_total " << static_cast<double>(std::clock()) / CLOCKS_PER_SEC << "\n";
+
+    ss << "# HELP regoth_frame_time_seconds Real time taken by a frame\n"
+       << "# TYPE regoth_frame_time_seconds histogram\n";
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < m_FrameTimeBounds.size(); i++)
+    {
+        cumulative += m_FrameTimeBuckets[i];
+        ss << "regoth_frame_time_seconds_bucket{le=\"" << m_FrameTimeBounds[i] << "\"} " << cumulative << "\n";
+    }
+
+    cumulative += m_FrameTimeBuckets.back();
+    ss << "regoth_frame_time_seconds_bucket{le=\"+Inf\"} " << cumulative << "\n"
+       << "regoth_frame_time_seconds_sum " << m_FrameTimeSum << "\n"
+       << "regoth_frame_time_seconds_count " << m_FrameTimeCount << "\n";
+
+    gauge("regoth_quality_level", "Current level of the quality-governor");
+    ss << "regoth_quality_level " << engine.getQualityGovernor().getLevel() << "\n";
+
+    gauge("regoth_jobs_queued", "Jobs waiting for the main-thread");
+    ss << "regoth_jobs_queued " << engine.getJobManager().getNumQueuedJobs() << "\n";
+
+    gauge("regoth_jobs_async", "Jobs running on other threads");
+    ss << "regoth_jobs_async " << engine.getJobManager().getNumAsyncJobs() << "\n";
+
+    if (!engine.getMainWorld().isValid())
+        return ss.str();
+
+    World::WorldInstance& world = engine.getMainWorld().get();
+
+    // Count entities by object-type and by some of the more expensive components
+    size_t num = world.getComponentAllocator().getNumObtainedElements();
+    const auto& ctuple = world.getComponentDataBundle().m_Data;
+
+    Components::EntityComponent* ents = std::get<Components::EntityComponent*>(ctuple);
+    Components::ObjectComponent* objects = std::get<Components::ObjectComponent*>(ctuple);
+
+    const char* typeNames[] = {"vob", "npc", "item", "other", "none"};
+    size_t byType[5] = {};
+    size_t numLogic = 0, numVisual = 0, numPhysics = 0, numAnimated = 0, numPfx = 0;
+
+    for (size_t i = 0; i < num; i++)
+    {
+        if (Components::hasComponent<Components::ObjectComponent>(ents[i]))
+            byType[std::min(static_cast<size_t>(objects[i].m_Type), size_t(3))]++;
+        else
+            byType[4]++;
+
+        numLogic += Components::hasComponent<Components::LogicComponent>(ents[i]) ? 1 : 0;
+        numVisual += Components::hasComponent<Components::VisualComponent>(ents[i]) ? 1 : 0;
+        numPhysics += Components::hasComponent<Components::PhysicsComponent>(ents[i]) ? 1 : 0;
+        numAnimated += Components::hasComponent<Components::AnimationComponent>(ents[i]) ? 1 : 0;
+        numPfx += Components::hasComponent<Components::PfxComponent>(ents[i]) ? 1 : 0;
+    }
+
+    gauge("regoth_entities", "Entities in the main world by object-type");
+    for (size_t i = 0; i < 5; i++)
+        ss << "regoth_entities{type=\"" << typeNames[i] << "\"} " << byType[i] << "\n";
+
+    gauge("regoth_entity_components", "Entities in the main world having the given component");
+    ss << "regoth_entity_components{component=\"logic\"} " << numLogic << "\n"
+       << "regoth_entity_components{component=\"visual\"} " << numVisual << "\n"
+       << "regoth_entity_components{component=\"physics\"} " << numPhysics << "\n"
+       << "regoth_entity_components{component=\"animation\"} " << numAnimated << "\n"
+       << "regoth_entity_components{component=\"pfx\"} " << numPfx << "\n";
+
+    gauge("regoth_streamed_vobs", "Vobs handled by the vob-streamer");
+    ss << "regoth_streamed_vobs{state=\"live\"} " << world.getVobStreamer().getNumLiveVobs() << "\n"
+       << "regoth_streamed_vobs{state=\"dormant\"} " << world.getVobStreamer().getNumDormantVobs() << "\n";
+
+    gauge("regoth_loose_items", "Items lying in the world without being an entity");
+    ss << "regoth_loose_items " << world.getLooseItems().getItems().size() << "\n";
+
+    const Logic::ProjectileManager::Stats& projectiles = world.getProjectileManager().getStats();
+    gauge("regoth_projectiles", "Projectiles handled in the last update");
+    ss << "regoth_projectiles{state=\"flying\"} " << projectiles.flying << "\n"
+       << "regoth_projectiles{state=\"stuck\"} " << projectiles.stuck << "\n";
+
+    gauge("regoth_npc_pool_size", "NPC-shells waiting for reuse");
+    ss << "regoth_npc_pool_size " << world.getNpcPool().getNumPooled() << "\n";
+
+    const World::RouteCache::Stats& routes = world.getRouteCache().getStats();
+    ss << "# HELP regoth_route_cache_requests_total Waynet-routes requested from the route-cache\n"
+       << "# TYPE regoth_route_cache_requests_total counter\n"
+       << "regoth_route_cache_requests_total{result=\"hit\"} " << routes.hits << "\n"
+       << "regoth_route_cache_requests_total{result=\"miss\"} " << routes.misses << "\n";
+
+    gauge("regoth_route_cache_routes", "Waynet-routes currently cached");
+    ss << "regoth_route_cache_routes " << world.getRouteCache().getNumRoutes() << "\n";
+
+    const Logic::PfxManager::ParticleStats& particles = world.getPfxManager().getParticleStats();
+    gauge("regoth_particles", "Particles handled in the last logic-tick");
+    ss << "regoth_particles{state=\"simulated\"} " << particles.simulated << "\n"
+       << "regoth_particles{state=\"skipped\"} " << particles.skipped << "\n"
+       << "regoth_particles{state=\"culled\"} " << particles.culled << "\n";
+
+    gauge("regoth_allocator_bytes", "Estimated memory used by the content-allocators of the main world");
+    ss << "regoth_allocator_bytes{allocator=\"textures\"} " << world.getTextureAllocator().getEstimatedGPUMemoryConsumption() << "\n"
+       << "regoth_allocator_bytes{allocator=\"static_meshes\"} " << world.getStaticMeshAllocator().getEstimatedGPUMemoryConsumption() << "\n"
+       << "regoth_allocator_bytes{allocator=\"skeletal_meshes\"} " << world.getSkeletalMeshAllocator().getEstimatedGPUMemoryConsumption() << "\n";
+
+    return ss.str();
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    class BaseEngine;
+
+    /**
+     * Collects a couple of engine-wide counters and serves them, together with a snapshot of the
+     * main world, in Prometheus' text-format. Listens on a localhost TCP-port (--metrics-port)
+     * or a Unix-socket (--metrics-socket). Disabled unless one of them is set.
+     *
+     * Connections are handled on the main thread, once per frame, so no locking is needed for the
+     * world-state. Counters may be increased from any thread.
+     */
+    class MetricsServer
+    {
+    public:
+        enum ECounter
+        {
+            C_PhysicsRaytraces,
+            C_PhysicsSweeps,
+            C_ScriptCalls,
+            C_Frames,
+            C_NumCounters
+        };
+
+        MetricsServer();
+        ~MetricsServer();
+
+        /**
+         * Opens the listening socket, if enabled
+         */
+        void init();
+
+        /**
+         * @return Whether the endpoint is up
+         */
+        bool isEnabled() const { return m_ListenSocket >= 0; }
+
+        /**
+         * Increases the given counter by one
+         */
+        void count(ECounter counter) { m_Counters[counter]++; }
+
+        /**
+         * @return Current value of the given counter
+         */
+        uint64_t getCounter(ECounter counter) const { return m_Counters[counter]; }
+
+        /**
+         * Records the frametime and answers pending requests
+         * @param engine Engine to take the snapshot of
+         * @param dt Frametime in seconds, not scaled by the game-speed
+         */
+        void onFrame(BaseEngine& engine, double dt);
+
+        /**
+         * @return All metrics in Prometheus' text-format
+         */
+        std::string buildReport(BaseEngine& engine);
+
+    private:
+        struct Client
+        {
+            int socket;
+            std::string request;
+            float age;
+        };
+
+        void acceptClients();
+        void updateClients(BaseEngine& engine, float dt);
+        void closeSocket(int socket);
+
+        /**
+         * Frametime-histogram. Upper bounds in seconds, counts are not cumulative.
+         */
+        std::vector<double> m_FrameTimeBounds;
+        std::vector<uint64_t> m_FrameTimeBuckets;
+        double m_FrameTimeSum;
+        uint64_t m_FrameTimeCount;
+
+        std::atomic<uint64_t> m_Counters[C_NumCounters];
+
+        int m_ListenSocket;
+        std::string m_UnixSocketPath;
+        std::vector<Client> m_Clients;
+    };
+}
@@ -37,6 +37,7 @@ using namespace Engine;
 uint32_t Platform::m_WindowWidth = 0;
 uint32_t Platform::m_WindowHeight = 0;
 bool Platform::m_Quit = false;
+double Platform::m_LastFrameWaitTime = 0.0;
 
 void Platform::windowSizeEvent(int width, int height)
 {
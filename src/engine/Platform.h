@@ -23,6 +23,22 @@ namespace Engine
         static bool getQuit() { return m_Quit; }
         static void setQuit(bool quit) { m_Quit = quit; }
 
+        /**
+         * @return Whether nothing is going on which needs a high framerate, like when the game is paused
+         */
+        virtual bool isIdle() { return false; }
+
+        /**
+         * @return Whether frametimes are being measured, so frames must not be held back
+         */
+        virtual bool isMeasuring() { return false; }
+
+        /**
+         * @return Time the main-loop spent waiting for the last frame to start, in seconds. Part of the frametime,
+         *         but not of the work done in it.
+         */
+        static double getLastFrameWaitTime() { return m_LastFrameWaitTime; }
+
     protected:
         static void windowSizeEvent(int width, int height);
 
@@ -32,5 +48,7 @@ namespace Engine
          * Size of the current window
          */
         static uint32_t m_WindowWidth, m_WindowHeight;
+
+        static double m_LastFrameWaitTime;
     };
 }
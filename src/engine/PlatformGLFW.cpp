@@ -3,7 +3,9 @@
 #include <bx/platform.h>
 #if BX_PLATFORM_LINUX || BX_PLATFORM_OSX || BX_PLATFORM_WINDOWS || BX_PLATFORM_EMSCRIPTEN || BX_PLATFORM_BSD
 #include <thread>
+#include "FramePacer.h"
 #include "PlatformGLFW.h"
+#include <utils/logger.h>
 
 // #include "utils/Utils.h"
 namespace Utils
@@ -278,6 +280,8 @@ int32_t PlatformGLFW::run(int argc, char** argv)
     std::cout << "Running emscripten main-loop" << std::endl;
     emscripten_set_main_loop([]() { g_Platform->update(); }, 0, 1);
 #else
+    FramePacer pacer;
+
     /* Loop until the user closes the window */
     while (true)
     {
@@ -294,7 +298,19 @@ int32_t PlatformGLFW::run(int argc, char** argv)
             break;
 
         update();
+
+        // Don't burn a whole core when nobody is looking
+        FramePacer::EActivity activity = FramePacer::A_Active;
+        if (glfwGetWindowAttrib(window, GLFW_ICONIFIED) || !glfwGetWindowAttrib(window, GLFW_FOCUSED))
+            activity = FramePacer::A_Background;
+        else if (isIdle())
+            activity = FramePacer::A_Idle;
+
+        // Performance-scenarios measure the engine, not the pacer
+        m_LastFrameWaitTime = isMeasuring() ? 0.0 : pacer.waitForNextFrame(activity);
     }
+
+    LogInfo() << "Spent " << pacer.getTotalWaitTime() << "s waiting for the next frame";
 #endif
 
     return 0;
@@ -0,0 +1,152 @@
+#include "QualityGovernor.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <utils/cli.h>
+#include <utils/logger.h>
+
+using namespace Engine;
+
+namespace Flags
+{
+    Cli::Flag qualityTargetFrameTime("", "quality-target-frametime", 1, "Frametime in milliseconds the engine tries to hold by lowering draw-distance, update-range and effect-detail. 0 disables this.", {"0"}, "Rendering");
+    Cli::Flag qualityMinDrawDistance("", "quality-min-draw-distance", 1, "Lowest factor the draw-distance may be scaled down to by --quality-target-frametime", {"0.5"}, "Rendering");
+    Cli::Flag qualityMinUpdateRange("", "quality-min-update-range", 1, "Lowest factor the logic update-range may be scaled down to by --quality-target-frametime", {"0.6"}, "Rendering");
+}
+
+/**
+ * Smoothing of the frametime. Higher values react faster.
+ */
+const float FRAMETIME_SMOOTHING = 0.1f;
+
+/**
+ * Hysteresis-band around the target. Inside of it, nothing is changed.
+ */
+const float SLOW_THRESHOLD = 1.1f;
+const float FAST_THRESHOLD = 0.8f;
+
+/**
+ * Frames in a row which have to be outside of the band before something is changed.
+ * Quality goes down quickly, but only slowly up again, so we don't oscillate around the target.
+ */
+const size_t NUM_FRAMES_UNTIL_DECREASE = 15;
+const size_t NUM_FRAMES_UNTIL_INCREASE = 120;
+
+/**
+ * Minimum time in seconds between two changes
+ */
+const float DECREASE_COOLDOWN = 0.5f;
+const float INCREASE_COOLDOWN = 2.0f;
+
+const float DECREASE_STEP = 0.1f;
+const float INCREASE_STEP = 0.05f;
+
+/**
+ * Frames taking longer than this are hitches (loading, ...) and not taken into account
+ */
+const float MAX_FRAMETIME = 0.5f;
+
+/**
+ * Lower bounds of the knobs which aren't configurable
+ */
+const float MIN_ANIMATION_RANGE_SCALE = 0.25f;
+const float MIN_PARTICLE_DENSITY = 0.25f;
+
+QualityGovernor::QualityGovernor()
+    : m_TargetFrameTime(0.0f)
+    , m_MinDrawDistanceScale(1.0f)
+    , m_MinUpdateRangeScale(1.0f)
+    , m_Level(1.0f)
+    , m_AverageFrameTime(0.0f)
+    , m_NumSlowFrames(0)
+    , m_NumFastFrames(0)
+    , m_TimeSinceChange(0.0f)
+{
+    m_TargetFrameTime = std::max(0.0f, static_cast<float>(atof(Flags::qualityTargetFrameTime.getParam(0).c_str()))) / 1000.0f;
+    m_MinDrawDistanceScale = std::min(1.0f, std::max(0.0f, static_cast<float>(atof(Flags::qualityMinDrawDistance.getParam(0).c_str()))));
+    m_MinUpdateRangeScale = std::min(1.0f, std::max(0.0f, static_cast<float>(atof(Flags::qualityMinUpdateRange.getParam(0).c_str()))));
+}
+
+void QualityGovernor::onFrame(double dt)
+{
+    if (!isEnabled() || dt <= 0.0 || dt > MAX_FRAMETIME)
+        return;
+
+    if (m_AverageFrameTime == 0.0f)
+        m_AverageFrameTime = static_cast<float>(dt);
+    else
+        m_AverageFrameTime += (static_cast<float>(dt) - m_AverageFrameTime) * FRAMETIME_SMOOTHING;
+
+    m_TimeSinceChange += static_cast<float>(dt);
+
+    if (m_AverageFrameTime > m_TargetFrameTime * SLOW_THRESHOLD)
+    {
+        m_NumSlowFrames++;
+        m_NumFastFrames = 0;
+    }
+    else if (m_AverageFrameTime < m_TargetFrameTime * FAST_THRESHOLD)
+    {
+        m_NumFastFrames++;
+        m_NumSlowFrames = 0;
+    }
+    else
+    {
+        m_NumSlowFrames = 0;
+        m_NumFastFrames = 0;
+    }
+
+    if (m_NumSlowFrames >= NUM_FRAMES_UNTIL_DECREASE && m_TimeSinceChange >= DECREASE_COOLDOWN && m_Level > 0.0f)
+    {
+        m_Level = std::max(0.0f, m_Level - DECREASE_STEP);
+        m_NumSlowFrames = 0;
+        m_TimeSinceChange = 0.0f;
+
+        LogInfo() << "Quality lowered to " << m_Level << " (Frametime: " << m_AverageFrameTime * 1000.0f << "ms)";
+    }
+    else if (m_NumFastFrames >= NUM_FRAMES_UNTIL_INCREASE && m_TimeSinceChange >= INCREASE_COOLDOWN && m_Level < 1.0f)
+    {
+        m_Level = std::min(1.0f, m_Level + INCREASE_STEP);
+        m_NumFastFrames = 0;
+        m_TimeSinceChange = 0.0f;
+
+        LogInfo() << "Quality raised to " << m_Level << " (Frametime: " << m_AverageFrameTime * 1000.0f << "ms)";
+    }
+}
+
+float QualityGovernor::getDrawDistanceScale() const
+{
+    return m_MinDrawDistanceScale + (1.0f - m_MinDrawDistanceScale) * m_Level;
+}
+
+float QualityGovernor::getUpdateRangeScale() const
+{
+    return m_MinUpdateRangeScale + (1.0f - m_MinUpdateRangeScale) * m_Level;
+}
+
+float QualityGovernor::getAnimationRangeScale() const
+{
+    return MIN_ANIMATION_RANGE_SCALE + (1.0f - MIN_ANIMATION_RANGE_SCALE) * m_Level;
+}
+
+float QualityGovernor::getParticleDensity() const
+{
+    return MIN_PARTICLE_DENSITY + (1.0f - MIN_PARTICLE_DENSITY) * m_Level;
+}
+
+std::string QualityGovernor::getStatusLine() const
+{
+    if (!isEnabled())
+        return "Quality: fixed";
+
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), "Quality: %.2f (Draw %.2f, Update %.2f, Anim %.2f, Pfx %.2f) Avg % 7.3f[ms] / Target %.3f[ms]",
+             m_Level,
+             getDrawDistanceScale(),
+             getUpdateRangeScale(),
+             getAnimationRangeScale(),
+             getParticleDensity(),
+             m_AverageFrameTime * 1000.0f,
+             m_TargetFrameTime * 1000.0f);
+
+    return buffer;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace Engine
+{
+    /**
+     * Watches the recent frame-times and scales a couple of detail-settings up or down to hold a target frame-time.
+     * All knobs are derived from a single quality-level in [0, 1], where 1 means full quality.
+     * Disabled unless --quality-target-frametime is set.
+     */
+    class QualityGovernor
+    {
+    public:
+        QualityGovernor();
+
+        /**
+         * @return Whether the governor is allowed to change anything
+         */
+        bool isEnabled() const { return m_TargetFrameTime > 0.0f; }
+
+        /**
+         * Feeds the real time the last frame took. Adjusts the quality-level, if needed.
+         * @param dt Frametime in seconds, not scaled by the game-speed
+         */
+        void onFrame(double dt);
+
+        /**
+         * @return Current quality-level in [0, 1]
+         */
+        float getLevel() const { return m_Level; }
+
+        /**
+         * @return Factor to apply to the draw-distance
+         */
+        float getDrawDistanceScale() const;
+
+        /**
+         * @return Factor to apply to the range in which entities get updated
+         */
+        float getUpdateRangeScale() const;
+
+        /**
+         * @return Fraction of the update-range in which animations are updated every frame.
+         *         Anything further away only gets every other frame.
+         */
+        float getAnimationRangeScale() const;
+
+        /**
+         * @return Factor to apply to the spawnrate of particle-effects
+         */
+        float getParticleDensity() const;
+
+        /**
+         * @return Smoothed frametime in seconds, as used for the decisions
+         */
+        float getAverageFrameTime() const { return m_AverageFrameTime; }
+
+        /**
+         * @return One line describing the current decisions, for the stats-overlay
+         */
+        std::string getStatusLine() const;
+
+    private:
+        /**
+         * Target frametime in seconds. 0 if disabled.
+         */
+        float m_TargetFrameTime;
+
+        /**
+         * Lower bounds for the distances, given by the user
+         */
+        float m_MinDrawDistanceScale;
+        float m_MinUpdateRangeScale;
+
+        float m_Level;
+        float m_AverageFrameTime;
+
+        /**
+         * Number of frames in a row which were above/below the hysteresis-band
+         */
+        size_t m_NumSlowFrames;
+        size_t m_NumFastFrames;
+
+        /**
+         * Time since the level was last changed
+         */
+        float m_TimeSinceChange;
+    };
+}
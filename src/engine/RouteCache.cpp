@@ -0,0 +1,75 @@
+#include "RouteCache.h"
+#include <engine/World.h>
+
+using namespace World;
+
+/**
+ * Maximum number of routes kept. A route of an average routine has a few dozen waypoints, so this stays
+ * well below a megabyte.
+ */
+const size_t MAX_CACHED_ROUTES = 2048;
+
+RouteCache::RouteCache(WorldInstance& world)
+    : m_WaynetRevision(0)
+    , m_World(world)
+{
+}
+
+std::vector<Waynet::WaypointIndex> RouteCache::findWay(Waynet::WaypointIndex start, Waynet::WaypointIndex end)
+{
+    const Waynet::WaynetInstance& waynet = m_World.getWaynet();
+
+    if (waynet.revision != m_WaynetRevision)
+    {
+        if (!m_Routes.empty())
+            m_Stats.invalidations++;
+
+        clear();
+        m_WaynetRevision = waynet.revision;
+    }
+
+    RouteKey key = makeRouteKey(start, end);
+
+    auto it = m_RoutesByKey.find(key);
+    if (it != m_RoutesByKey.end())
+    {
+        // Move to the front, so it is the last to be evicted
+        m_Routes.splice(m_Routes.begin(), m_Routes, it->second);
+        m_Stats.hits++;
+
+        return it->second->path;
+    }
+
+    m_Stats.misses++;
+
+    // Also remember when there is no way at all, those are the most expensive searches
+    m_Routes.push_front({key, Waynet::findWay(waynet, start, end)});
+    m_RoutesByKey[key] = m_Routes.begin();
+
+    if (m_Routes.size() > MAX_CACHED_ROUTES)
+    {
+        m_RoutesByKey.erase(m_Routes.back().key);
+        m_Routes.pop_back();
+        m_Stats.evictions++;
+    }
+
+    return m_Routes.front().path;
+}
+
+void RouteCache::clear()
+{
+    m_Routes.clear();
+    m_RoutesByKey.clear();
+}
+
+float RouteCache::getHitRate() const
+{
+    size_t total = m_Stats.hits + m_Stats.misses;
+
+    return total ? static_cast<float>(m_Stats.hits) / total : 0.0f;
+}
+
+RouteCache::RouteKey RouteCache::makeRouteKey(Waynet::WaypointIndex start, Waynet::WaypointIndex end) const
+{
+    return (static_cast<RouteKey>(static_cast<uint32_t>(start)) << 32) | static_cast<uint32_t>(end);
+}
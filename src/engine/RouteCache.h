@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "Waynet.h"
+
+namespace World
+{
+    class WorldInstance;
+
+    /**
+     * Remembers routes found on the waynet of a world, keyed by start- and end-waypoint. NPCs walk the same
+     * routes of their daily routines over and over, which then costs a lookup instead of a search.
+     * Routes nobody asked for in a while are dropped first. Everything is dropped once the waynet changes.
+     */
+    class RouteCache
+    {
+    public:
+        struct Stats
+        {
+            /**
+             * Requests which could/couldn't be answered from the cache
+             */
+            size_t hits = 0;
+            size_t misses = 0;
+
+            /**
+             * Routes dropped to make room for new ones
+             */
+            size_t evictions = 0;
+
+            /**
+             * Times the whole cache was dropped because the waynet changed
+             */
+            size_t invalidations = 0;
+        };
+
+        RouteCache(WorldInstance& world);
+
+        /**
+         * Same as Waynet::findWay on the waynet of the world, but only searches routes not known yet
+         * @return list of all waypoints that need to be visited. Will be empty if none was found.
+         */
+        std::vector<Waynet::WaypointIndex> findWay(Waynet::WaypointIndex start, Waynet::WaypointIndex end);
+
+        /**
+         * Drops all routes. To be called when the waynet was replaced.
+         */
+        void clear();
+
+        /**
+         * @return Number of routes currently cached
+         */
+        size_t getNumRoutes() const { return m_Routes.size(); }
+
+        /**
+         * @return Fraction of requests answered from the cache, 0..1
+         */
+        float getHitRate() const;
+
+        const Stats& getStats() const { return m_Stats; }
+
+    private:
+        typedef uint64_t RouteKey;
+
+        struct Route
+        {
+            RouteKey key;
+            std::vector<Waynet::WaypointIndex> path;
+        };
+
+        RouteKey makeRouteKey(Waynet::WaypointIndex start, Waynet::WaypointIndex end) const;
+
+        /**
+         * Cached routes, most recently used first
+         */
+        std::list<Route> m_Routes;
+        std::unordered_map<RouteKey, std::list<Route>::iterator> m_RoutesByKey;
+
+        /**
+         * Revision of the waynet the cached routes were found on
+         */
+        size_t m_WaynetRevision;
+
+        Stats m_Stats;
+
+        WorldInstance& m_World;
+    };
+}
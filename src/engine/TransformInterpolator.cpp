@@ -0,0 +1,123 @@
+#include "TransformInterpolator.h"
+#include <algorithm>
+#include <cstring>
+#include <components/Entities.h>
+#include <engine/World.h>
+
+using namespace World;
+
+/**
+ * Entities which moved further than this within a single tick were teleported, ie. by goto, AI_Teleport or a
+ * routine-reset. They are shown at their new place right away instead of being blended across the jump. In meters.
+ */
+const float MAX_INTERPOLATED_DISTANCE = 5.0f;
+
+namespace
+{
+    bool isSameTransform(const Math::Matrix& a, const Math::Matrix& b)
+    {
+        return memcmp(a.mv, b.mv, sizeof(a.mv)) == 0;
+    }
+}
+
+TransformInterpolator::TransformInterpolator(WorldInstance& world)
+    : m_World(world)
+{
+}
+
+void TransformInterpolator::beginTick()
+{
+    size_t num = m_World.getComponentAllocator().getNumObtainedElements();
+    const auto& ctuple = m_World.getComponentDataBundle().m_Data;
+
+    Components::EntityComponent* ents = std::get<Components::EntityComponent*>(ctuple);
+    Components::PositionComponent* positions = std::get<Components::PositionComponent*>(ctuple);
+
+    m_PreviousTransforms.resize(num);
+    m_PreviousEntities.resize(num);
+
+    for (size_t i = 0; i < num; i++)
+    {
+        m_PreviousTransforms[i] = positions[i].m_WorldMatrix;
+        m_PreviousEntities[i] = ents[i].m_ThisEntity;
+    }
+}
+
+void TransformInterpolator::endTick()
+{
+    m_Moved.clear();
+
+    size_t num = std::min(m_World.getComponentAllocator().getNumObtainedElements(), m_PreviousTransforms.size());
+    const auto& ctuple = m_World.getComponentDataBundle().m_Data;
+
+    Components::EntityComponent* ents = std::get<Components::EntityComponent*>(ctuple);
+    Components::PositionComponent* positions = std::get<Components::PositionComponent*>(ctuple);
+
+    for (size_t i = 0; i < num; i++)
+    {
+        // Entities get moved around inside the allocator when others are removed. Those have no previous state here.
+        if (ents[i].m_ThisEntity != m_PreviousEntities[i])
+            continue;
+
+        if (!Components::hasComponent<Components::PositionComponent>(ents[i]))
+            continue;
+
+        if (isSameTransform(positions[i].m_WorldMatrix, m_PreviousTransforms[i]))
+            continue;
+
+        Math::float3 distance = positions[i].m_WorldMatrix.Translation() - m_PreviousTransforms[i].Translation();
+        if (distance.lengthSquared() > MAX_INTERPOLATED_DISTANCE * MAX_INTERPOLATED_DISTANCE)
+            continue;
+
+        MovedEntity m;
+        m.index = i;
+        m.entity = ents[i].m_ThisEntity;
+        m.previous = m_PreviousTransforms[i];
+        m.current = positions[i].m_WorldMatrix;
+        m.applied = false;
+        m_Moved.push_back(m);
+    }
+}
+
+void TransformInterpolator::apply(float alpha)
+{
+    size_t num = m_World.getComponentAllocator().getNumObtainedElements();
+    const auto& ctuple = m_World.getComponentDataBundle().m_Data;
+
+    Components::EntityComponent* ents = std::get<Components::EntityComponent*>(ctuple);
+    Components::PositionComponent* positions = std::get<Components::PositionComponent*>(ctuple);
+
+    for (MovedEntity& m : m_Moved)
+    {
+        m.applied = false;
+
+        // Don't touch anything which was removed or teleported since the last tick
+        if (m.index >= num || ents[m.index].m_ThisEntity != m.entity)
+            continue;
+
+        if (!isSameTransform(positions[m.index].m_WorldMatrix, m.current))
+            continue;
+
+        // Plain blending of the matrix. Rotations between two ticks are small enough for this to look right.
+        for (int j = 0; j < 16; j++)
+            m.blended.mv[j] = m.previous.mv[j] + (m.current.mv[j] - m.previous.mv[j]) * alpha;
+
+        positions[m.index].m_WorldMatrix = m.blended;
+        m.applied = true;
+    }
+}
+
+void TransformInterpolator::restore()
+{
+    const auto& ctuple = m_World.getComponentDataBundle().m_Data;
+    Components::PositionComponent* positions = std::get<Components::PositionComponent*>(ctuple);
+
+    for (MovedEntity& m : m_Moved)
+    {
+        // Leave alone what was moved after apply(), like the camera following the blended player
+        if (m.applied && isSameTransform(positions[m.index].m_WorldMatrix, m.blended))
+            positions[m.index].m_WorldMatrix = m.current;
+
+        m.applied = false;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <handle/HandleDef.h>
+#include <math/mathlib.h>
+
+namespace World
+{
+    class WorldInstance;
+
+    /**
+     * Smooths out movement when the logic runs at a lower rate than the renderer.
+     * Remembers the transforms of all entities before a logic-tick and, for those which moved during it,
+     * blends between the old and the new transform while rendering. Entities which jumped during a tick are not blended.
+     *
+     * The blended transforms are only written into the position-components between apply() and restore(),
+     * everything else always sees the state of the last logic-tick.
+     */
+    class TransformInterpolator
+    {
+    public:
+        TransformInterpolator(WorldInstance& world);
+
+        /**
+         * Takes a snapshot of all transforms. To be called right before a logic-tick.
+         */
+        void beginTick();
+
+        /**
+         * Finds the entities which moved since beginTick(), but not far enough to count as teleported
+         */
+        void endTick();
+
+        /**
+         * Writes the blended transforms of all moved entities
+         * @param alpha Time since the last logic-tick, as fraction of a tick. 0 means the state of the previous tick.
+         */
+        void apply(float alpha);
+
+        /**
+         * Writes back the transforms of the last logic-tick, unless they were changed since apply()
+         */
+        void restore();
+
+        /**
+         * @return Number of entities which get interpolated
+         */
+        size_t getNumMovedEntities() const { return m_Moved.size(); }
+
+    private:
+        struct MovedEntity
+        {
+            size_t index;
+            Handle::EntityHandle entity;
+            Math::Matrix previous;
+            Math::Matrix current;
+            Math::Matrix blended;
+
+            /**
+             * Whether apply() has overwritten the transform
+             */
+            bool applied;
+        };
+
+        WorldInstance& m_World;
+
+        /**
+         * Transforms and entities as they were in beginTick(), by component-index
+         */
+        std::vector<Math::Matrix> m_PreviousTransforms;
+        std::vector<Handle::EntityHandle> m_PreviousEntities;
+
+        std::vector<MovedEntity> m_Moved;
+    };
+}
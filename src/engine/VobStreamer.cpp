@@ -0,0 +1,436 @@
+#include "VobStreamer.h"
+#include <cmath>
+#include <components/Vob.h>
+#include <components/VobClasses.h>
+#include <engine/LightProbeGrid.h>
+#include <engine/World.h>
+#include <logic/ScriptEngine.h>
+#include <logic/VisualController.h>
+#include <utils/cli.h>
+#include <utils/logger.h>
+
+using namespace World;
+
+namespace Flags
+{
+    Cli::Flag vobStreamingRadius("", "vob-streaming-radius", 1,
+                                 "Radius in meters around the camera in which plain vobs and items are kept as entities. "
+                                 "Anything further away is stored as a compact record. 0 disables streaming.",
+                                 {"0"}, "Rendering");
+}
+
+/**
+ * Size of a single streaming cell in meters
+ */
+const float VOB_STREAMING_CELL_SIZE = 32.0f;
+
+/**
+ * Invalid item symbol, used for plain vobs
+ */
+const size_t NO_ITEM = static_cast<size_t>(-1);
+
+VobStreamer::VobStreamer(WorldInstance& world)
+    : m_CameraCell(0)
+    , m_HasCameraCell(false)
+    , m_Radius(0.0f)
+    , m_CellSize(VOB_STREAMING_CELL_SIZE)
+    , m_NumDormant(0)
+    , m_NumLive(0)
+    , m_World(world)
+{
+    m_Radius = std::max(0.0f, static_cast<float>(atof(Flags::vobStreamingRadius.getParam(0).c_str())));
+}
+
+bool VobStreamer::addVob(const ZenLoad::zCVobData& v)
+{
+    if (!isEnabled())
+        return false;
+
+    // Named vobs may be referenced by scripts, everything without visual is cheap anyways
+    if (!v.vobName.empty() || v.visual.empty())
+        return false;
+
+    VobRecord record;
+
+    if (v.objectClass == "oCItem:zCVob")
+    {
+        // Let the usual path report invalid instances
+        if (!m_World.getScriptEngine().hasSymbol(v.oCItem.instanceName))
+            return false;
+
+        record.itemSymbol = m_World.getScriptEngine().getSymbolIndexByName(v.oCItem.instanceName);
+    }
+    else if (v.objectClass != "zCVob")
+    {
+        return false;
+    }
+
+    record.transform = Math::Matrix(v.worldMatrix.mv);
+    record.transform.Translation(record.transform.Translation() * (1.0f / 100.0f));
+
+    record.bbox = {Math::float3(v.bbox[0].v) * (1.0f / 100.0f),
+                   Math::float3(v.bbox[1].v) * (1.0f / 100.0f)};
+    record.hasBBox = true;
+
+    record.visual = v.visual;
+
+    // Items don't get collision, see ItemController
+    record.collision = v.cdDyn && record.itemSymbol == NO_ITEM;
+
+    insertRecord(std::move(record));
+    return true;
+}
+
+bool VobStreamer::addVob(const json& j)
+{
+    if (!isEnabled() || j.find("visual") == j.end())
+        return false;
+
+    VobRecord record;
+
+    if (j.find("logic") != j.end())
+    {
+        if (j["logic"]["type"] != "ItemController")
+            return false;
+
+        record.itemSymbol = j["logic"]["instanceSymbol"];
+    }
+
+    const json& jvisual = j["visual"];
+    const json& jtrans = jvisual["transform"];
+
+    record.transform = Math::Matrix::CreateIdentity();
+    for (int i = 0; i < 16; i++)
+        if (!jtrans[i].is_null())
+            record.transform.mv[i] = jtrans[i];
+
+    record.visual = jvisual["name"].get<std::string>();
+    record.collision = jvisual["collision"];
+
+    if (j.find("streaming") != j.end())
+    {
+        const json& jstreaming = j["streaming"];
+
+        if (jstreaming.find("bbox") != jstreaming.end())
+        {
+            const json& jbbox = jstreaming["bbox"];
+            record.bbox = {Math::float3(jbbox[0].get<float>(), jbbox[1].get<float>(), jbbox[2].get<float>()),
+                           Math::float3(jbbox[3].get<float>(), jbbox[4].get<float>(), jbbox[5].get<float>())};
+            record.hasBBox = true;
+        }
+
+        record.shadow = jstreaming.value("shadow", -1.0f);
+    }
+
+    record.state = j;
+    record.state.erase("streaming");
+
+    insertRecord(std::move(record));
+    return true;
+}
+
+void VobStreamer::update(const Math::float3& cameraPosition)
+{
+    if (!isEnabled())
+        return;
+
+    int cx, cz;
+    CellKey cameraCell = cellKeyOf(cameraPosition, cx, cz);
+
+    // Only need to do something when a cell-border was crossed
+    if (m_HasCameraCell && cameraCell == m_CameraCell)
+        return;
+
+    m_CameraCell = cameraCell;
+    m_HasCameraCell = true;
+
+    int range = static_cast<int>(std::ceil(m_Radius / m_CellSize));
+
+    // Tear down cells which went out of range. Keep one extra ring, so walking along a border doesn't
+    // cause the same cells to be loaded and unloaded over and over again.
+    for (auto it = m_LoadedCells.begin(); it != m_LoadedCells.end();)
+    {
+        int x = static_cast<int32_t>(*it >> 32);
+        int z = static_cast<int32_t>(*it & 0xFFFFFFFF);
+
+        if (std::abs(x - cx) > range + 1 || std::abs(z - cz) > range + 1)
+        {
+            auto cellIt = m_Cells.find(*it);
+            if (cellIt != m_Cells.end())
+                unloadCell(cellIt->second);
+
+            it = m_LoadedCells.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // Entitify everything which came into range
+    for (int x = cx - range; x <= cx + range; x++)
+    {
+        for (int z = cz - range; z <= cz + range; z++)
+        {
+            CellKey key = makeCellKey(x, z);
+
+            if (!m_LoadedCells.insert(key).second)
+                continue;
+
+            auto cellIt = m_Cells.find(key);
+            if (cellIt != m_Cells.end())
+                loadCell(cellIt->second);
+        }
+    }
+}
+
+void VobStreamer::exportRecords(json& controllers)
+{
+    for (auto& c : m_Cells)
+    {
+        for (auto& l : c.second.live)
+        {
+            if (!m_World.isEntityValid(l.first))
+                continue;
+
+            Vob::VobInformation vob = Vob::asVob(m_World, l.first);
+
+            json j;
+            m_World.exportControllers(vob.logic, vob.visual, j);
+
+            if (j.empty())
+                continue;
+
+            json record = exportRecord(l.second);
+            record.erase("logic");
+            record.erase("visual");
+
+            for (auto it = j.begin(); it != j.end(); ++it)
+                record[it.key()] = it.value();
+
+            controllers.push_back(record);
+        }
+
+        for (const VobRecord& r : c.second.dormant)
+            controllers.push_back(exportRecord(r));
+    }
+}
+
+void VobStreamer::clear()
+{
+    for (auto& c : m_Cells)
+    {
+        for (auto& l : c.second.live)
+        {
+            if (!m_World.isEntityValid(l.first))
+                continue;
+
+            if (l.second.itemSymbol != NO_ITEM)
+                m_World.getScriptEngine().unregisterItem(l.first);
+
+            m_World.removeEntity(l.first);
+        }
+    }
+
+    m_Cells.clear();
+    m_LoadedCells.clear();
+    m_HasCameraCell = false;
+    m_NumDormant = 0;
+    m_NumLive = 0;
+}
+
+void VobStreamer::getLiveEntities(std::set<Handle::EntityHandle>& entities) const
+{
+    for (const auto& c : m_Cells)
+        for (const auto& l : c.second.live)
+            entities.insert(l.first);
+}
+
+VobStreamer::CellKey VobStreamer::makeCellKey(int x, int z) const
+{
+    return (static_cast<CellKey>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+}
+
+VobStreamer::CellKey VobStreamer::cellKeyOf(const Math::float3& position, int& x, int& z) const
+{
+    x = static_cast<int>(std::floor(position.x / m_CellSize));
+    z = static_cast<int>(std::floor(position.z / m_CellSize));
+
+    return makeCellKey(x, z);
+}
+
+void VobStreamer::insertRecord(VobRecord&& record)
+{
+    int x, z;
+    CellKey key = cellKeyOf(record.transform.Translation(), x, z);
+    Cell& cell = m_Cells[key];
+
+    if (m_LoadedCells.find(key) != m_LoadedCells.end())
+    {
+        Handle::EntityHandle e = entitify(record);
+
+        if (e.isValid())
+        {
+            cell.live.emplace_back(e, std::move(record));
+            m_NumLive++;
+        }
+    }
+    else
+    {
+        cell.dormant.push_back(std::move(record));
+        m_NumDormant++;
+    }
+}
+
+void VobStreamer::loadCell(Cell& cell)
+{
+    std::vector<VobRecord> dormant;
+    std::swap(dormant, cell.dormant);
+    m_NumDormant -= dormant.size();
+
+    for (VobRecord& r : dormant)
+    {
+        Handle::EntityHandle e = entitify(r);
+
+        if (!e.isValid())
+        {
+            LogWarn() << "Failed to entitify streamed vob: " << r.visual;
+            continue;
+        }
+
+        cell.live.emplace_back(e, std::move(r));
+        m_NumLive++;
+    }
+}
+
+void VobStreamer::unloadCell(Cell& cell)
+{
+    std::vector<std::pair<Handle::EntityHandle, VobRecord>> live;
+    std::swap(live, cell.live);
+    m_NumLive -= live.size();
+
+    for (auto& l : live)
+    {
+        // Entities which went away in the meantime (ie. picked up items) are simply forgotten
+        if (teardown(l.first, l.second))
+        {
+            cell.dormant.push_back(std::move(l.second));
+            m_NumDormant++;
+        }
+    }
+}
+
+Handle::EntityHandle VobStreamer::entitify(VobRecord& record)
+{
+    Handle::EntityHandle e;
+
+    if (record.state.empty())
+    {
+        if (record.itemSymbol != NO_ITEM)
+            e = VobTypes::createItem(m_World, record.itemSymbol);
+        else
+            e = Vob::constructVob(m_World);
+
+        Vob::VobInformation vob = Vob::asVob(m_World, e);
+        Vob::setTransform(vob, record.transform);
+
+        // Static collision is never removed from the world, so it must only be created once
+        Vob::setCollisionEnabled(vob, record.collision && !record.collisionCreated);
+        Vob::setVisual(vob, record.visual);
+    }
+    else
+    {
+        json j = record.state;
+
+        if (record.collisionCreated)
+            j["visual"]["collision"] = false;
+
+        e = m_World.importSingleVob(j);
+    }
+
+    if (!e.isValid())
+        return e;
+
+    Vob::VobInformation vob = Vob::asVob(m_World, e);
+    Vob::setCollisionEnabled(vob, record.collision);
+    record.collisionCreated = record.collisionCreated || record.collision;
+
+    Math::float3 position = record.transform.Translation();
+
+    if (record.hasBBox)
+    {
+        vob.position->m_DrawDistanceFactor = std::max(0.12f, std::min(1.0f, (record.bbox.max - record.bbox.min).length() / 10.0f));
+#ifdef ANDROID
+        vob.position->m_DrawDistanceFactor *= 0.6f;
+#endif
+
+        Vob::setBBox(vob, record.bbox.min - position, record.bbox.max - position, 0);
+    }
+
+    if (record.shadow < 0.0f)
+        record.shadow = m_World.getLightProbeGrid().sample(position);
+
+    if (vob.visual)
+        vob.visual->setShadowValue(record.shadow);
+
+    return e;
+}
+
+bool VobStreamer::teardown(Handle::EntityHandle e, VobRecord& record)
+{
+    if (!m_World.isEntityValid(e))
+        return false;
+
+    Vob::VobInformation vob = Vob::asVob(m_World, e);
+
+    json j;
+    m_World.exportControllers(vob.logic, vob.visual, j);
+
+    record.state = j;
+    record.transform = vob.position->m_WorldMatrix;
+
+    if (record.itemSymbol != NO_ITEM)
+        m_World.getScriptEngine().unregisterItem(e);
+
+    m_World.removeEntity(e);
+
+    return true;
+}
+
+json VobStreamer::exportRecord(const VobRecord& record)
+{
+    json j = record.state;
+
+    if (j.empty())
+    {
+        // Never been entitified, write what an export of the actual vob would look like
+        json& jvisual = j["visual"];
+        jvisual["type"] = "VisualController";
+        jvisual["name"] = record.visual;
+        jvisual["collision"] = record.collision;
+
+        for (int i = 0; i < 16; i++)
+            jvisual["transform"].push_back(record.transform.mv[i]);
+
+        if (record.itemSymbol != NO_ITEM)
+        {
+            json& jlogic = j["logic"];
+            jlogic["type"] = "ItemController";
+            jlogic["instanceSymbol"] = record.itemSymbol;
+            jlogic["collision"] = false;
+            jlogic["transform"] = jvisual["transform"];
+        }
+    }
+
+    // Information which would otherwise only be available from the ZEN
+    json& jstreaming = j["streaming"];
+    jstreaming["shadow"] = record.shadow;
+
+    if (record.hasBBox)
+    {
+        jstreaming["bbox"] = {record.bbox.min.x, record.bbox.min.y, record.bbox.min.z,
+                              record.bbox.max.x, record.bbox.max.y, record.bbox.max.z};
+    }
+
+    return j;
+}
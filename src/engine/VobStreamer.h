@@ -0,0 +1,172 @@
+#pragma once
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <handle/HandleDef.h>
+#include <json.hpp>
+#include <math/mathlib.h>
+#include <utils/Utils.h>
+#include <zenload/zTypes.h>
+
+using json = nlohmann::json;
+
+namespace World
+{
+    class WorldInstance;
+
+    /**
+     * Partitions the plain vobs and items of a world into a grid of cells on the XZ-plane.
+     * Only cells around the camera are turned into actual entities. Everything else is kept as
+     * a compact record, which is entitified again once the camera comes close enough.
+     */
+    class VobStreamer
+    {
+    public:
+        /**
+         * Everything needed to recreate a streamed vob
+         */
+        struct VobRecord
+        {
+            /**
+             * World-transform, already in meters
+             */
+            Math::Matrix transform;
+
+            /**
+             * World-space bounding box. Only valid if hasBBox is set
+             */
+            Utils::BBox3D bbox;
+            bool hasBBox = false;
+
+            /**
+             * Visual to load on entitification
+             */
+            std::string visual;
+
+            /**
+             * Script-instance of the item, or (size_t)-1 for plain vobs
+             */
+            size_t itemSymbol = static_cast<size_t>(-1);
+
+            /**
+             * Whether the vob has static collision and whether that was already added to the world
+             */
+            bool collision = false;
+            bool collisionCreated = false;
+
+            /**
+             * Shadow-value sampled from the worldmesh. Negative if not known yet.
+             */
+            float shadow = -1.0f;
+
+            /**
+             * Exported controllers of the vob, once it was torn down at least once. Empty otherwise.
+             */
+            json state;
+        };
+
+        VobStreamer(WorldInstance& world);
+
+        /**
+         * @return Whether streaming is enabled for this world (see --vob-streaming-radius)
+         */
+        bool isEnabled() const { return m_Radius > 0.0f; }
+
+        /**
+         * Tries to store the given vob from a ZEN-file as record
+         * @return Whether the vob was taken. If false, it must be created as usual.
+         */
+        bool addVob(const ZenLoad::zCVobData& v);
+
+        /**
+         * Tries to store the given vob from a savegame as record
+         * @return Whether the vob was taken. If false, it must be imported as usual.
+         */
+        bool addVob(const json& j);
+
+        /**
+         * Entitifies and tears down cells as the camera crosses cell-borders
+         * @param cameraPosition Current position of the camera
+         */
+        void update(const Math::float3& cameraPosition);
+
+        /**
+         * Writes all records which are currently not entitified into the given array, using the same
+         * format as WorldInstance::exportControllers, so they can be read by WorldInstance::importSingleVob
+         * @param controllers json-array to append to
+         */
+        void exportRecords(json& controllers);
+
+        /**
+         * Removes all entities created from records and drops every record
+         */
+        void clear();
+
+        /**
+         * @param entities [out] Set to put the entities created from records into
+         */
+        void getLiveEntities(std::set<Handle::EntityHandle>& entities) const;
+
+        /**
+         * @return Number of vobs currently stored as records/entities
+         */
+        size_t getNumDormantVobs() const { return m_NumDormant; }
+        size_t getNumLiveVobs() const { return m_NumLive; }
+
+    private:
+        typedef uint64_t CellKey;
+
+        struct Cell
+        {
+            std::vector<VobRecord> dormant;
+            std::vector<std::pair<Handle::EntityHandle, VobRecord>> live;
+        };
+
+        CellKey makeCellKey(int x, int z) const;
+        CellKey cellKeyOf(const Math::float3& position, int& x, int& z) const;
+
+        /**
+         * Puts the given record into the cell matching its position. Entitifies it right away, if that
+         * cell is currently loaded.
+         */
+        void insertRecord(VobRecord&& record);
+
+        void loadCell(Cell& cell);
+        void unloadCell(Cell& cell);
+
+        /**
+         * @return Entity created from the given record. Updates the record with information gathered on the way.
+         */
+        Handle::EntityHandle entitify(VobRecord& record);
+
+        /**
+         * Writes the state of the given entity into the record and removes it from the world
+         * @return false, if the entity got removed by someone else in the meantime
+         */
+        bool teardown(Handle::EntityHandle e, VobRecord& record);
+
+        /**
+         * @return The record in exported form
+         */
+        json exportRecord(const VobRecord& record);
+
+        std::unordered_map<CellKey, Cell> m_Cells;
+        std::set<CellKey> m_LoadedCells;
+
+        /**
+         * Cell the camera was in on the last update
+         */
+        CellKey m_CameraCell;
+        bool m_HasCameraCell;
+
+        float m_Radius;
+        float m_CellSize;
+
+        size_t m_NumDormant;
+        size_t m_NumLive;
+
+        WorldInstance& m_World;
+    };
+}
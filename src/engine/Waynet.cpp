@@ -17,6 +17,17 @@ void Waynet::addWaypoint(WaynetInstance& waynet, const Waypoint& wp)
 {
     waynet.waypoints.push_back(wp);
     waynet.waypointsByName[wp.name] = waynet.waypoints.size() - 1;
+    waynet.revision++;
+}
+
+/**
+ * @brief Connects the two given waypoints in both directions
+ */
+void Waynet::addEdge(WaynetInstance& waynet, WaypointIndex a, WaypointIndex b)
+{
+    waynet.waypoints[a].edges.push_back(b);
+    waynet.waypoints[b].edges.push_back(a);
+    waynet.revision++;
 }
 
 Waynet::WaynetInstance Waynet::makeWaynetFromZen(const ZenLoad::oCWorldData& zenWorld)
@@ -54,8 +65,7 @@ Waynet::WaynetInstance Waynet::makeWaynetFromZen(const ZenLoad::oCWorldData& zen
         // FIXME: I'm not sure whether this means that this is meant to be a directed graph or not.
         // FIXME: Going for undirected...
 
-        w.waypoints[e.first].edges.push_back(e.second);
-        w.waypoints[e.second].edges.push_back(e.first);
+        addEdge(w, e.first, e.second);
     }
 
     return w;
@@ -45,6 +45,11 @@ namespace World
              * Map of waypoint names to their indices in the waypoints-vector
              */
             std::map<std::string, WaypointIndex> waypointsByName;
+
+            /**
+             * Increased whenever waypoints or edges change, so data derived from the waynet can tell it is outdated
+             */
+            size_t revision = 0;
         };
 
         /**
@@ -52,6 +57,11 @@ namespace World
          */
         void addWaypoint(WaynetInstance& waynet, const Waypoint& wp);
 
+        /**
+         * @brief Connects the two given waypoints in both directions
+         */
+        void addEdge(WaynetInstance& waynet, WaypointIndex a, WaypointIndex b);
+
         /**
          * @brief Creates a waynet from the given loaded zen-world
          */
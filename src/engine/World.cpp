@@ -19,6 +19,7 @@
 #include <logic/PlayerController.h>
 #include <logic/SoundController.h>
 #include <logic/MusicController.h>
+#include <logic/NpcPool.h>
 #include <ui/Hud.h>
 #include <ui/LoadingScreen.h>
 #include <ui/PrintScreenMessages.h>
@@ -27,11 +28,17 @@
 #include <zenload/zenParser.h>
 #include <type_traits>
 #include "BspTree.h"
+#include "LightProbeGrid.h"
+#include "TransformInterpolator.h"
+#include "VobStreamer.h"
+#include "LooseItems.h"
+#include "RouteCache.h"
 #include "WorldMesh.h"
 #include <physics/PhysicsSystem.h>
 #include <content/Sky.h>
 #include <logic/DialogManager.h>
 #include <logic/PfxManager.h>
+#include <logic/ProjectileManager.h>
 #include <logic/ScriptEngine.h>
 #include "WorldAllocators.h"
 
@@ -49,10 +56,17 @@ public:
         , dialogManager(world)
         , bspTree(world)
         , pfxManager(world)
+        , projectileManager(world)
+        , vobStreamer(world)
+        , looseItems(world)
+        , npcPool(world)
+        , routeCache(world)
+        , transformInterpolator(world)
         , audioWorld(nullptr)
     {}
 
     WorldMesh worldMesh;
+    LightProbeGrid lightProbes;
     BspTree bspTree;
     Waynet::WaynetInstance waynet;
     Logic::ScriptEngine scriptEngine;
@@ -62,6 +76,12 @@ public:
     Content::Sky sky;
     Logic::DialogManager dialogManager;
     Logic::PfxManager pfxManager;
+    Logic::ProjectileManager projectileManager;
+    VobStreamer vobStreamer;
+    LooseItems looseItems;
+    Logic::NpcPool npcPool;
+    RouteCache routeCache;
+    TransformInterpolator transformInterpolator;
 };
 
 struct LoadSection
@@ -83,6 +103,8 @@ WorldInstance::WorldInstance(Engine::BaseEngine& engine)
     , m_Allocators(std::make_unique<WorldAllocators>(engine))
     , m_ClassContents(std::make_unique<ClassContents>(*this))
 {
+    m_FrameIndex = 0;
+    m_IsTearingDown = false;
     Logic::MusicController::resetDefaults();
 }
 
@@ -98,32 +120,8 @@ WorldInstance::~WorldInstance()
 
     // Destructor might get called from different thread
     auto destroyComponents = [this](Engine::BaseEngine* engine){
-        // Destroy all allocated components
-        // Loop because some destructor may create more entities
-        while(getComponentAllocator().getNumObtainedElements() != 0)
-        {
-            auto ents = getComponentAllocator().getDataBundle();
-            Components::EntityComponent* entityComponents = std::get<Components::EntityComponent*>(ents.m_Data);
-
-            // Need to make a list of all entites because some destructors could remove some entites inside
-            std::vector<Handle::EntityHandle> allEntities;
-            for (size_t i = 0; i < ents.m_NumElements; i++)
-            {
-                allEntities.push_back(entityComponents[i].m_ThisEntity);
-            }
+        destroyAllEntities();
 
-            for (Handle::EntityHandle e : allEntities)
-            {
-                if (isEntityValid(e))
-                {
-                    Components::Actions::forAllComponents(getComponentAllocator(), e, [&](auto& v) {
-                        Components::Actions::destroyComponent(v);
-                    });
-
-                    getComponentAllocator().removeObject(e);
-                }
-            }
-        }
         // explicitly call destructors (containing bgfx calls) in main-thread
         m_ClassContents = nullptr;
         m_Allocators = nullptr;
@@ -224,9 +222,15 @@ bool WorldInstance::init(const std::string& zen,
 
         m_pEngine->getHud().getLoadingScreen().setSectionProgress(20);
 
-        // Init worldmesh-wrapper
+        // Init worldmesh-wrapper. From here on, it holds the triangles used for collision and material-lookups.
         m_ClassContents->worldMesh.load(packedWorldMesh);
 
+        // Not needed anymore, the de-indexed triangles take up more memory than everything else together
+        std::vector<ZenLoad::WorldTriangle>().swap(packedWorldMesh.triangles);
+
+        // Lighting for vobs and NPCs, looked up by position from here on
+        m_ClassContents->lightProbes.bake(m_ClassContents->worldMesh);
+
         for (auto& sm : packedWorldMesh.subMeshes)
         {
             size_t k = 0;
@@ -247,19 +251,9 @@ bool WorldInstance::init(const std::string& zen,
 
         // TODO: Put these into a compound-component or something
         std::vector<Handle::EntityHandle> ents;
-        Handle::MeshHandle worldMeshHandle = getStaticMeshAllocator().loadFromPacked(packedWorldMesh, "WORLDMESH.3DS");
 
         m_pEngine->getHud().getLoadingScreen().setSectionProgress(80);
 
-        /*Handle::EntityHandle eh = Vob::constructVob(*this);
-        Vob::VobInformation wvob = Vob::asVob(*this, eh);
-        wvob.position->m_DrawDistanceFactor = 0.0f;
-        Vob::setVisual(wvob, "WORLDMESH.3DS");
-        Vob::setTransform(wvob, Math::Matrix::CreateIdentity());
-*/
-
-        Meshes::WorldStaticMesh& worldMeshData = getStaticMeshAllocator().getMesh(worldMeshHandle);
-
         for (size_t i = 0; i < packedWorldMesh.subMeshes.size(); i++)
         {
             Handle::MeshHandle h = getStaticMeshAllocator().loadFromPackedSubmesh(packedWorldMesh, i, "");
@@ -276,10 +270,6 @@ bool WorldInstance::init(const std::string& zen,
             LOAD_SECTION_COLLISION.p2,
             LOAD_SECTION_COLLISION.info);
 
-        // If we haven't already, create an instancebuffer for this mesh
-        //if(worldMeshData.instanceDataBufferIndex == (uint32_t)-1)
-        //    worldMeshData.instanceDataBufferIndex = ((Engine::GameEngine*)m_pEngine)->getDefaultRenderSystem().requestInstanceDataBuffer();
-
         // Create collisionmesh for the world
         if (!ents.empty())
         {
@@ -294,7 +284,9 @@ bool WorldInstance::init(const std::string& zen,
             m_pEngine->getHud().getLoadingScreen().setSectionProgress(50);
 
             // Add world-mesh collision
-            Handle::CollisionShapeHandle wmch = getPhysicsSystem().makeCollisionShapeFromMesh(packedWorldMesh.triangles, Physics::CollisionShape::CT_WorldMesh);
+            Handle::CollisionShapeHandle wmch = getPhysicsSystem().makeCollisionShapeFromIndexedMesh(m_ClassContents->worldMesh.getPositions(),
+                                                                                                     m_ClassContents->worldMesh.getIndices(),
+                                                                                                     Physics::CollisionShape::CT_WorldMesh);
             getPhysicsSystem().compoundShapeAddChild(m_StaticWorldMeshCollsionShape, wmch);
 
         }
@@ -333,6 +325,14 @@ bool WorldInstance::init(const std::string& zen,
                 numVobsLoaded += 1;
                 m_pEngine->getHud().getLoadingScreen().setSectionProgress((100 * (int)numVobsLoaded) / (int)world.numVobsTotal);
 
+                // Items nobody has touched yet don't need to be entities
+                if (m_ClassContents->looseItems.addVob(v))
+                    continue;
+
+                // Far away plain vobs and items are only created once the camera comes close
+                if (m_ClassContents->vobStreamer.addVob(v))
+                    continue;
+
                 bool allowCollision = true;  // FIXME: Hack. Items shouldn't be placed into physicsworld right now
 
                 // Check for special vobs // FIXME: Should be somewhere else
@@ -454,24 +454,9 @@ bool WorldInstance::init(const std::string& zen,
                                  Math::float3(v.bbox[1].v) * (1.0f / 100.0f) - m.Translation(),
                                  0 /*vob.visual ? 0 : 0xFF00AA00*/);
 
-                    // Trace down from this vob to get the shadow-value from the worldmesh
-                    Math::float3 traceStart = Math::float3(m.Translation().x, v.bbox[1].y * (1.0f / 100.0f), m.Translation().z);
-                    Math::float3 traceEnd = Math::float3(m.Translation().x, (v.bbox[0].y * (1.0f / 100.0f)) - 5.0f, m.Translation().z);
-                    Physics::RayTestResult hit = m_ClassContents->physicsSystem.raytrace(traceStart, traceEnd,
-                                                                          Physics::CollisionShape::CT_WorldMesh);  // FIXME: Use boundingbox for this
-
-                    if (hit.hasHit)
-                    {
-                        float shadow = m_ClassContents->worldMesh.interpolateTriangleShadowValue(hit.hitTriangleIndex, hit.hitPosition);
-
-                        if (Vob::getVisual(vob))
-                            Vob::getVisual(vob)->setShadowValue(shadow);
-                    }
-                    else
-                    {
-                        if (Vob::getVisual(vob))
-                            Vob::getVisual(vob)->setShadowValue(0.6);
-                    }
+                    // Get the shadow-value from the lighting of the worldmesh below this vob
+                    if (Vob::getVisual(vob))
+                        Vob::getVisual(vob)->setShadowValue(m_ClassContents->lightProbes.sample(m.Translation()));
                 }
             }
         };
@@ -517,6 +502,9 @@ bool WorldInstance::init(const std::string& zen,
             Waynet::addWaypoint(m_ClassContents->waynet, startWP);
         }
 
+        // Routes found on a previous waynet are no good anymore
+        m_ClassContents->routeCache.clear();
+
         // Notify user
         m_pEngine->getHud().getLoadingScreen().startSection(
             LOAD_SECTION_RUNSCRIPTS.p1,
@@ -661,13 +649,18 @@ void WorldInstance::onFrameUpdate(double deltaTime, float updateRangeSquared, co
 {
     // Tell script engine the frame started
     m_ClassContents->scriptEngine.onFrameStart();
+    m_ClassContents->pfxManager.onTickStart();
 
     // Update physics
     m_ClassContents->physicsSystem.update(deltaTime);
+    m_ClassContents->projectileManager.update(deltaTime);
 
     // Update sky
     m_ClassContents->sky.interpolate();
 
+    // Create/remove streamed vobs around the camera
+    m_ClassContents->vobStreamer.update(cameraWorld.Translation());
+
     size_t num = getComponentAllocator().getNumObtainedElements();
     const auto& ctuple = getComponentDataBundle().m_Data;
 
@@ -678,15 +671,25 @@ void WorldInstance::onFrameUpdate(double deltaTime, float updateRangeSquared, co
     Components::PositionComponent* positions = std::get<Components::PositionComponent*>(ctuple);
     Components::VisualComponent* visuals = std::get<Components::VisualComponent*>(ctuple);
 
+    // Animations outside of this range are only updated every other frame
+    float animationRange = m_pEngine->getQualityGovernor().getAnimationRangeScale();
+    float animationRangeSquared = updateRangeSquared * animationRange * animationRange;
+    m_FrameIndex++;
+
     //#pragma omp parallel for
     for (size_t i = 0; i < num; i++)
     {
+        bool fullAnimationRate = true;
+
         // Simple distance-check // TODO: Frustum/Occlusion-Culling
         if (Components::hasComponent<Components::PositionComponent>(ents[i]))
         {
-            if ((positions[i].m_WorldMatrix.Translation() - cameraWorld.Translation()).lengthSquared() >
-                updateRangeSquared * positions[i].m_DrawDistanceFactor)
+            float distanceSquared = (positions[i].m_WorldMatrix.Translation() - cameraWorld.Translation()).lengthSquared();
+
+            if (distanceSquared > updateRangeSquared * positions[i].m_DrawDistanceFactor)
                 continue;
+
+            fullAnimationRate = distanceSquared <= animationRangeSquared * positions[i].m_DrawDistanceFactor;
         }
 
         Components::ComponentMask mask = ents[i].m_ComponentMask;
@@ -709,7 +712,10 @@ void WorldInstance::onFrameUpdate(double deltaTime, float updateRangeSquared, co
         // Update animations, only if there isn't a valid parent registered
         if (Components::hasComponent<Components::AnimationComponent>(ents[i]) && !anims[i].m_ParentAnimHandler.isValid())
         {
-            anims[i].getAnimHandler().updateAnimations(deltaTime);
+            if (fullAnimationRate)
+                anims[i].getAnimHandler().updateAnimations(deltaTime);
+            else if ((m_FrameIndex + ents[i].m_ThisEntity.index) % 2 == 0)  // Array-index changes as entities come and go
+                anims[i].getAnimHandler().updateAnimations(deltaTime * 2.0);
         }
     }
 
@@ -752,13 +758,43 @@ void WorldInstance::onFrameUpdate(double deltaTime, float updateRangeSquared, co
     }
 }
 
+void WorldInstance::destroyAllEntities()
+{
+    m_IsTearingDown = true;
+
+    // Nothing gets removed from the allocator from here on, so indices stay stable while the
+    // controllers are deleted. Loop because some destructors may create more entities.
+    size_t first = 0;
+    size_t num = getComponentAllocator().getNumObtainedElements();
+    while (first < num)
+    {
+        auto ctuple = getComponentDataBundle().m_Data;
+        Components::EntityComponent* ents = std::get<Components::EntityComponent*>(ctuple);
+
+        Utils::for_each_in_tuple(ctuple, [&](auto* components) {
+            typedef typename std::remove_pointer<decltype(components)>::type C;
+
+            for (size_t i = first; i < num; i++)
+            {
+                if (Components::hasComponent<C>(ents[i]))
+                    Components::Actions::destroyComponent(components[i]);
+            }
+        });
+
+        first = num;
+        num = getComponentAllocator().getNumObtainedElements();
+    }
+
+    getComponentAllocator().clear();
+}
+
 void WorldInstance::removeEntity(Handle::EntityHandle h)
 {
+    if (m_IsTearingDown)
+        return;  // Released together with all other entities
+
     if(!isEntityValid(h))
     {
-        // FIXME: Reason for this is, that on the final world-clean, entities are removed in the wrong order.
-        // FIXME: Thus, when cleaning complex objects, there sub-entites might already be deleted and so their handle has become invalid.
-
         LogWarn() << "Tried to delete an entity with an invalid handle!";
         return; // Already deleted!
     }
@@ -932,6 +968,9 @@ void WorldInstance::exportWorld(json& j, std::set<Handle::EntityHandle> skip)
     {
         json& jvobs = j["vobs"];
 
+        // Streamed vobs are written along with their records
+        m_ClassContents->vobStreamer.getLiveEntities(skip);
+
         size_t num = getComponentAllocator().getNumObtainedElements();
         const auto& ctuple = getComponentDataBundle().m_Data;
 
@@ -954,6 +993,9 @@ void WorldInstance::exportWorld(json& j, std::set<Handle::EntityHandle> skip)
             // Do the actual export
             exportControllers(logicController, visualController, jvobs["controllers"][i]);
         }
+
+        m_ClassContents->vobStreamer.exportRecords(jvobs["controllers"]);
+        m_ClassContents->looseItems.exportRecords(jvobs["controllers"]);
     }
 }
 
@@ -1027,7 +1069,7 @@ void WorldInstance::importVobs(const json& j)
     size_t numTotal = j["controllers"].size();
     for (const json& vob : j["controllers"])
     {
-        if (!vob.is_null())
+        if (!vob.is_null() && !m_ClassContents->looseItems.addVob(vob) && !m_ClassContents->vobStreamer.addVob(vob))
         {
             importSingleVob(vob);
         }
@@ -1037,6 +1079,110 @@ void WorldInstance::importVobs(const json& j)
     }
 }
 
+void WorldInstance::importSavegameState(const json& worldJson,
+                                        const json& scriptEngine,
+                                        const json& dialogManager,
+                                        const json& logManager)
+{
+    assert(worldJson["zenfile"] == m_ZenFile);
+
+    if (getDialogManager().isDialogActive())
+    {
+        getDialogManager().cancelTalk();
+        getDialogManager().endDialog();
+    }
+
+    // NPCs have to go through the script-engine. This also puts them into the NPC-pool, so the imported
+    // ones don't have to load their models again.
+    std::set<Handle::EntityHandle> npcs = getScriptEngine().getWorldNPCs();
+    for (Handle::EntityHandle e : npcs)
+        VobTypes::Wld_RemoveNpc(*this, e);
+
+    m_ClassContents->vobStreamer.clear();
+    m_ClassContents->looseItems.clear();
+    m_ClassContents->projectileManager.clear();
+
+    // Everything else which would end up in a savegame gets removed. Entities without any exported controller
+    // are parts of the worldmesh, freepoints, the camera or sound-vobs, which the savegame doesn't bring back.
+    std::set<Handle::EntityHandle> keep;
+    m_ClassContents->npcPool.getPooledEntities(keep);
+    keep.insert(m_Camera);
+
+    std::vector<Handle::EntityHandle> dynamicEntities;
+    {
+        size_t num = getComponentAllocator().getNumObtainedElements();
+        const auto& ctuple = getComponentDataBundle().m_Data;
+
+        Components::EntityComponent* ents = std::get<Components::EntityComponent*>(ctuple);
+        Components::LogicComponent* logics = std::get<Components::LogicComponent*>(ctuple);
+        Components::VisualComponent* visuals = std::get<Components::VisualComponent*>(ctuple);
+
+        for (size_t i = 0; i < num; i++)
+        {
+            if (keep.find(ents[i].m_ThisEntity) != keep.end())
+                continue;
+
+            Logic::Controller* logicController = nullptr;
+            Logic::VisualController* visualController = nullptr;
+            if (Components::hasComponent<Components::LogicComponent>(ents[i]))
+                logicController = logics[i].m_pLogicController;
+            if (Components::hasComponent<Components::VisualComponent>(ents[i]))
+                visualController = visuals[i].m_pVisualController;
+
+            // Same as in exportControllers(). A logic-controller which isn't saved would be lost for good.
+            if (logicController && !logicController->shouldExport())
+                continue;
+
+            bool exported = (logicController && logicController->shouldExport())
+                            || (visualController && visualController->shouldExport());
+
+            if (exported)
+                dynamicEntities.push_back(ents[i].m_ThisEntity);
+        }
+    }
+
+    for (Handle::EntityHandle e : dynamicEntities)
+    {
+        // Removing one entity may take others with it (ie. attachments)
+        if (!isEntityValid(e))
+            continue;
+
+        getScriptEngine().unregisterItem(e);
+        removeEntity(e);
+    }
+
+    for (auto it = m_VobsByNames.begin(); it != m_VobsByNames.end();)
+    {
+        if (!isEntityValid((*it).second))
+            it = m_VobsByNames.erase(it);
+        else
+            ++it;
+    }
+
+    for (auto& fp : m_FreePoints)
+        getEntity<Components::SpotComponent>(fp.second).m_UsingEntity.invalidate();
+
+    // Static collision of the removed vobs would stay inside the world otherwise
+    m_ClassContents->physicsSystem.compoundShapeRemoveAllChildren(m_StaticWorldObjectCollsionShape);
+
+    // Same order as in init()
+    LogInfo() << "Inserting vobs from json...";
+    importVobs(worldJson["vobs"]);
+
+    m_ClassContents->physicsSystem.postProcessLoad();
+
+    if (!scriptEngine.empty())
+        getScriptEngine().importScriptEngine(scriptEngine);
+
+    if (!dialogManager.empty())
+        m_ClassContents->dialogManager.importDialogManager(dialogManager);
+
+    if (!logManager.empty())
+        m_pEngine->getSession().getLogManager().importLogManager(logManager);
+
+    initializeScriptEngineForZenWorld(m_ZenFile.substr(0, m_ZenFile.find('.')), false);
+}
+
 bool WorldInstance::isEntityValid(Handle::EntityHandle e)
 {
     return m_Allocators->m_ComponentAllocator.isHandleValid(e);
@@ -1144,6 +1290,16 @@ WorldMesh& WorldInstance::getWorldMesh()
     return m_ClassContents->worldMesh;
 }
 
+LightProbeGrid& WorldInstance::getLightProbeGrid()
+{
+    return m_ClassContents->lightProbes;
+}
+
+TransformInterpolator& WorldInstance::getTransformInterpolator()
+{
+    return m_ClassContents->transformInterpolator;
+}
+
 Content::Sky& WorldInstance::getSky()
 {
     return m_ClassContents->sky;
@@ -1164,11 +1320,36 @@ Logic::PfxManager& WorldInstance::getPfxManager()
     return m_ClassContents->pfxManager;
 }
 
+Logic::ProjectileManager& WorldInstance::getProjectileManager()
+{
+    return m_ClassContents->projectileManager;
+}
+
 Animations::AnimationLibrary& WorldInstance::getAnimationLibrary()
 {
     return m_ClassContents->animationLibrary;
 }
 
+VobStreamer& WorldInstance::getVobStreamer()
+{
+    return m_ClassContents->vobStreamer;
+}
+
+LooseItems& WorldInstance::getLooseItems()
+{
+    return m_ClassContents->looseItems;
+}
+
+Logic::NpcPool& WorldInstance::getNpcPool()
+{
+    return m_ClassContents->npcPool;
+}
+
+RouteCache& WorldInstance::getRouteCache()
+{
+    return m_ClassContents->routeCache;
+}
+
 Components::ComponentAllocator::DataBundle WorldInstance::getComponentDataBundle()
 {
     return m_Allocators->m_ComponentAllocator.getDataBundle();
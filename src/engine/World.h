@@ -33,6 +33,8 @@ namespace Logic
 {
     class DialogManager;
     class PfxManager;
+    class ProjectileManager;
+    class NpcPool;
     class CameraController;
     class ScriptEngine;
 }
@@ -64,7 +66,12 @@ namespace Animations
 namespace World
 {
     class AudioWorld;
+    class VobStreamer;
+    class LooseItems;
+    class RouteCache;
     class WorldMesh;
+    class LightProbeGrid;
+    class TransformInterpolator;
     struct WorldAllocators;
 
     namespace Waynet
@@ -215,11 +222,18 @@ namespace World
 
 
         WorldMesh& getWorldMesh();
+        LightProbeGrid& getLightProbeGrid();
         Content::Sky& getSky();
         Logic::DialogManager& getDialogManager();
         World::AudioWorld& getAudioWorld();
         Logic::PfxManager& getPfxManager();
+        Logic::ProjectileManager& getProjectileManager();
         Animations::AnimationLibrary& getAnimationLibrary();
+        VobStreamer& getVobStreamer();
+        LooseItems& getLooseItems();
+        RouteCache& getRouteCache();
+        Logic::NpcPool& getNpcPool();
+        TransformInterpolator& getTransformInterpolator();
 
         /**
          * HUD's print-screen manager
@@ -319,6 +333,17 @@ namespace World
          */
         void importVobs(const json& j);
 
+        /**
+         * Throws away all dynamic state of this world (NPCs, items, mobs, vobs, script-globals) and imports it again
+         * from a savegame of this very world. Worldmesh, BSP-tree, waynet and the worldmesh-collision are kept.
+         * The player is not imported, use importVobAndTakeControl() for that afterwards.
+         * @param worldJson Exported world. Must have been exported from the same zen-file
+         */
+        void importSavegameState(const json& worldJson,
+                                 const json& scriptEngine,
+                                 const json& dialogManager,
+                                 const json& logManager);
+
         /**
          * Imports a single vob from a json-object
          * @return entity handle if successfull, else invalid handle
@@ -350,6 +375,12 @@ namespace World
          */
         void initializeScriptEngineForZenWorld(const std::string& worldName, bool firstStart = true);
 
+        /**
+         * Destroys all components of all entities type by type and releases the whole allocator at once.
+         * removeEntity() does nothing while this runs, so nested visuals don't need to be taken apart in order.
+         */
+        void destroyAllEntities();
+
 
         TransientEntityFeatures m_TransientEntityFeatures;
 
@@ -388,6 +419,16 @@ namespace World
          */
         std::map<std::string, Handle::EntityHandle> m_FreePoints;
 
+        /**
+         * Number of frames this world was updated
+         */
+        size_t m_FrameIndex;
+
+        /**
+         * Set while the world is destroyed. Entities are released in bulk then.
+         */
+        bool m_IsTearingDown;
+
         /**
          * Usually freepoints are named like "FP_GUARD_XXX", where "FP_GUARD" is the 'tag' of
          * a freepoint. To save us from going through the whole freepoint list every time we need a
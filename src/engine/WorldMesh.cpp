@@ -11,46 +11,72 @@ WorldMesh::WorldMesh(World::WorldInstance& parentWorld)
 
 void WorldMesh::load(const ZenLoad::PackedMesh& in)
 {
-    m_WorldMeshData = in;
     m_BBox3d[0] = Math::float3(in.bbox[0].v);
     m_BBox3d[1] = Math::float3(in.bbox[1].v);
+
+    m_Positions.clear();
+    m_Colors.clear();
+    m_Indices.clear();
+    m_TriangleMaterials.clear();
+    m_Materials.clear();
+
+    m_Positions.reserve(in.vertices.size());
+    m_Colors.reserve(in.vertices.size());
+    for (const ZenLoad::WorldVertex& v : in.vertices)
+    {
+        m_Positions.emplace_back(v.Position.v);
+        m_Colors.push_back(v.Color);
+    }
+
+    size_t numIndices = 0;
+    for (const auto& sm : in.subMeshes)
+        numIndices += sm.indices.size();
+
+    m_Indices.reserve(numIndices);
+    m_TriangleMaterials.reserve(numIndices / 3);
+    m_Materials.reserve(in.subMeshes.size());
+
+    // Triangles are ordered by submesh, so the material of a triangle is simply the one of its submesh
+    for (size_t i = 0; i < in.subMeshes.size(); i++)
+    {
+        const auto& sm = in.subMeshes[i];
+
+        m_Materials.push_back(sm.material);
+        m_Indices.insert(m_Indices.end(), sm.indices.begin(), sm.indices.end());
+        m_TriangleMaterials.insert(m_TriangleMaterials.end(), sm.indices.size() / 3, static_cast<uint32_t>(i));
+    }
 }
 
 float WorldMesh::interpolateTriangleShadowValue(size_t triangleIdx, const Math::float3& worldPosition)
 {
-    assert(triangleIdx < m_WorldMeshData.triangles.size());
+    assert(triangleIdx < getNumTriangles());
 
-    ZenLoad::WorldTriangle& tri = m_WorldMeshData.triangles[triangleIdx];
+    const uint32_t* idx = &m_Indices[triangleIdx * 3];
 
     float u, v, w;
-    Math::barycentric(worldPosition, tri.vertices[0].Position.v, tri.vertices[1].Position.v, tri.vertices[2].Position.v, u, v, w);
+    Math::barycentric(worldPosition, m_Positions[idx[0]], m_Positions[idx[1]], m_Positions[idx[2]], u, v, w);
 
     Math::float4 c[3];
-    c[0].fromABGR8(tri.vertices[0].Color);
-    c[1].fromABGR8(tri.vertices[1].Color);
-    c[2].fromABGR8(tri.vertices[2].Color);
+    c[0].fromABGR8(m_Colors[idx[0]]);
+    c[1].fromABGR8(m_Colors[idx[1]]);
+    c[2].fromABGR8(m_Colors[idx[2]]);
 
     return (u * c[0] + v * c[1] + w * c[2]).x;  // Lighting is greyscale only
 }
 
 void WorldMesh::getTriangle(size_t triangleIdx, Math::float3* v3, uint8_t& matgroup)
 {
-    assert(triangleIdx < m_WorldMeshData.triangles.size());
-    ZenLoad::WorldTriangle& tri = m_WorldMeshData.triangles[triangleIdx];
-    if (static_cast<size_t>(tri.submeshIndex) < m_WorldMeshData.subMeshes.size() && tri.submeshIndex >= 0)
-        matgroup = m_WorldMeshData.subMeshes[tri.submeshIndex].material.matGroup;
-    else
-        matgroup = (uint8_t)ZenLoad::MaterialGroup::UNDEF;
+    assert(triangleIdx < getNumTriangles());
+    matgroup = m_Materials[m_TriangleMaterials[triangleIdx]].matGroup;
 
     for (int i = 0; i < 3; i++)
-        v3[i] = Math::float3(tri.vertices[i].Position.v);
+        v3[i] = m_Positions[m_Indices[triangleIdx * 3 + i]];
 }
 
 ZenLoad::zCMaterialData WorldMesh::getMatData(size_t triangleIdx) const
 {
-    assert(triangleIdx < m_WorldMeshData.triangles.size());
-    assert(m_WorldMeshData.triangles[triangleIdx].submeshIndex < m_WorldMeshData.subMeshes.size());
-    return m_WorldMeshData.subMeshes[m_WorldMeshData.triangles[triangleIdx].submeshIndex].material;
+    assert(triangleIdx < getNumTriangles());
+    return m_Materials[m_TriangleMaterials[triangleIdx]];
 }
 
 ZenLoad::MaterialGroup WorldMesh::getMaterialGroupOfTriangle(uint32_t triangleIdx)
@@ -1,6 +1,8 @@
 #pragma once
+#include <vector>
 #include <content/StaticLevelMesh.h>
 #include <engine/WorldTypes.h>
+#include <zenload/zTypes.h>
 
 namespace ZenLoad
 {
@@ -12,6 +14,11 @@ namespace World
     class WorldInstance;
     typedef LevelMesh::StaticLevelMesh<WorldMeshVertex, WorldMeshIndex> WorldMeshData;
 
+    /**
+     * Indexed triangles of the worldmesh. This is the only copy of the triangles kept on the CPU-side:
+     * The collision-mesh references the positions and indices stored here directly, so triangle-indices
+     * reported by the physics-system can be used to look up materials and vertex-colors.
+     */
     class WorldMesh
     {
     public:
@@ -53,11 +60,43 @@ namespace World
          */
         ZenLoad::zCMaterialData getMatData(size_t triangleIdx) const;
 
+        /**
+         * @return Positions of all vertices, indexed by getIndices()
+         */
+        const std::vector<Math::float3>& getPositions() const { return m_Positions; }
+
+        /**
+         * @return 3 indices per triangle
+         */
+        const std::vector<uint32_t>& getIndices() const { return m_Indices; }
+
+        /**
+         * @return Baked lighting of every vertex as ABGR8
+         */
+        const std::vector<uint32_t>& getColors() const { return m_Colors; }
+
+        /**
+         * @return Number of triangles in the worldmesh
+         */
+        size_t getNumTriangles() const { return m_TriangleMaterials.size(); }
+
     protected:
         /**
-         * Data of the worldmesh
+         * Vertex-data of the worldmesh. Colors hold the baked lighting.
+         */
+        std::vector<Math::float3> m_Positions;
+        std::vector<uint32_t> m_Colors;
+
+        /**
+         * 3 indices per triangle, into m_Positions/m_Colors
+         */
+        std::vector<uint32_t> m_Indices;
+
+        /**
+         * Index into m_Materials for every triangle
          */
-        ZenLoad::PackedMesh m_WorldMeshData;
+        std::vector<uint32_t> m_TriangleMaterials;
+        std::vector<ZenLoad::zCMaterialData> m_Materials;
 
         /**
          * Reference to the parentworld
@@ -11,11 +11,14 @@
 using Logic::Console;
 
 Console::Console(Engine::BaseEngine& e)
-    : m_BaseEngine(e)
+    : m_Script(e)
+    , m_BaseEngine(e)
 {
     m_HistoryIndex = 0;
     m_Open = false;
     outputAdd(" ----------- REGoth Console -----------");
+
+    m_Script.registerCommands(*this);
 }
 
 Console::~Console()
@@ -9,6 +9,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include "ConsoleScript.h"
 #include <ui/ConsoleBox.h>
 
 namespace Logic
@@ -180,6 +181,11 @@ namespace Logic
         const std::string& getTypedLine() { return m_TypedLine; }
         const std::vector<std::vector<Logic::Console::Suggestion>>& getSuggestions() { return m_SuggestionsList; }
 
+        /**
+         * @return Runner for files of console-commands
+         */
+        ConsoleScript& getScript() { return m_Script; }
+
     private:
         /**
          * clears the suggestion list and sets the current selection index to 0
@@ -211,6 +217,11 @@ namespace Logic
          */
         std::list<Command> m_Commands;
 
+        /**
+         * Command-file currently running, if any
+         */
+        ConsoleScript m_Script;
+
         /**
          * suggestions for each token
          */
@@ -0,0 +1,312 @@
+#include "ConsoleScript.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <json.hpp>
+#include "Console.h"
+#include <engine/BaseEngine.h>
+#include <engine/World.h>
+#include <ui/Hud.h>
+#include <ui/LoadingScreen.h>
+#include <utils/Utils.h>
+#include <utils/logger.h>
+
+using namespace Logic;
+using json = nlohmann::json;
+
+/**
+ * Counters of the metrics-server which go into the reports, by the name used in scripts
+ */
+const std::pair<const char*, Engine::MetricsServer::ECounter> REPORTED_COUNTERS[] = {
+    {"raytraces", Engine::MetricsServer::C_PhysicsRaytraces},
+    {"sweeps", Engine::MetricsServer::C_PhysicsSweeps},
+    {"scriptcalls", Engine::MetricsServer::C_ScriptCalls},
+};
+
+namespace
+{
+    /**
+     * @return The given percentile (0..100) of the sorted values, nearest-rank
+     */
+    float percentile(const std::vector<float>& sorted, float p)
+    {
+        if (sorted.empty())
+            return 0.0f;
+
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0f * sorted.size()));
+        return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+    }
+}
+
+ConsoleScript::ConsoleScript(Engine::BaseEngine& e)
+    : m_NextLine(0)
+    , m_Wait(EWait::None)
+    , m_WaitRemaining(0.0)
+    , m_WaitFrames(0)
+    , m_HasFailed(false)
+    , m_Engine(e)
+{
+}
+
+void ConsoleScript::registerCommands(Console& console)
+{
+    console.registerCommand("exec", [this](const std::vector<std::string>& args) -> std::string {
+               if (args.size() < 2)
+                   return "Missing argument. Usage: exec <file>";
+
+               if (!load(args[1]))
+                   return "Failed to read file: " + args[1];
+
+               return "Running " + args[1];
+           })
+        .setRequiresWorld(false);
+
+    console.registerCommand("wait frames", [this](const std::vector<std::string>& args) -> std::string {
+               if (args.size() < 3)
+                   return "Missing argument. Usage: wait frames <n>";
+
+               m_Wait = EWait::Frames;
+               m_WaitFrames = static_cast<size_t>(std::max(0, std::stoi(args[2])));
+               return "Waiting " + args[2] + " frames";
+           })
+        .setRequiresWorld(false);
+
+    console.registerCommand("wait seconds", [this](const std::vector<std::string>& args) -> std::string {
+               if (args.size() < 3)
+                   return "Missing argument. Usage: wait seconds <s>";
+
+               m_Wait = EWait::Seconds;
+               m_WaitRemaining = std::stod(args[2]);
+               return "Waiting " + args[2] + " seconds";
+           })
+        .setRequiresWorld(false);
+
+    console.registerCommand("wait world", [this](const std::vector<std::string>& args) -> std::string {
+               // World-switches start at the end of the frame, give them one to get going
+               m_Wait = EWait::World;
+               m_WaitFrames = 1;
+               return "Waiting for the world to load";
+           })
+        .setRequiresWorld(false);
+
+    console.registerCommand("measure start", [this](const std::vector<std::string>& args) -> std::string {
+               if (args.size() < 3)
+                   return "Missing argument. Usage: measure start <name>";
+
+               Window& w = m_Windows[args[2]];
+               w.frameTimes.clear();
+               w.duration = 0.0;
+               w.limits.clear();
+
+               for (int i = 0; i < Engine::MetricsServer::C_NumCounters; i++)
+                   w.counters[i] = m_Engine.getMetrics().getCounter(static_cast<Engine::MetricsServer::ECounter>(i));
+
+               return "Started measuring " + args[2];
+           })
+        .setRequiresWorld(false);
+
+    console.registerCommand("measure limit", [this](const std::vector<std::string>& args) -> std::string {
+               if (args.size() < 5)
+                   return "Missing argument. Usage: measure limit <name> <avg|p50|p90|p95|p99|max|counter> <value>";
+
+               auto it = m_Windows.find(args[2]);
+               if (it == m_Windows.end())
+                   return "No measurement named " + args[2];
+
+               it->second.limits.push_back({args[3], std::stod(args[4])});
+               return "Limiting " + args[3] + " of " + args[2] + " to " + args[4];
+           })
+        .setRequiresWorld(false)
+        .registerAutoComplete(std::vector<std::string>())
+        .registerAutoComplete({"avg", "p50", "p90", "p95", "p99", "max", "raytraces", "sweeps", "scriptcalls"});
+
+    console.registerCommand("measure stop", [this](const std::vector<std::string>& args) -> std::string {
+               if (args.size() < 3)
+                   return "Missing argument. Usage: measure stop <name> [file]";
+
+               return stopWindow(args[2], args.size() > 3 ? args[3] : args[2] + ".perf.json");
+           })
+        .setRequiresWorld(false);
+}
+
+bool ConsoleScript::load(const std::string& file)
+{
+    std::ifstream f(file);
+    if (!f)
+    {
+        LogWarn() << "Failed to open console-script: " << file;
+        return false;
+    }
+
+    m_Lines.clear();
+
+    std::string line;
+    while (std::getline(f, line))
+    {
+        // Windows line-endings
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+
+        m_Lines.push_back(line.substr(start));
+    }
+
+    m_File = file;
+    m_NextLine = 0;
+    m_Wait = EWait::None;
+    m_HasFailed = false;
+
+    LogInfo() << "Running console-script " << file << " (" << m_Lines.size() << " commands)";
+    return true;
+}
+
+void ConsoleScript::onFrame(double dt)
+{
+    for (auto& w : m_Windows)
+    {
+        w.second.frameTimes.push_back(static_cast<float>(dt));
+        w.second.duration += dt;
+    }
+
+    if (m_Wait == EWait::Frames || m_Wait == EWait::World)
+    {
+        if (m_WaitFrames > 0)
+            m_WaitFrames--;
+    }
+    else if (m_Wait == EWait::Seconds)
+    {
+        m_WaitRemaining -= dt;
+    }
+
+    if (!isRunning() || !isWaitDone())
+        return;
+
+    m_Wait = EWait::None;
+
+    // Commands may start a wait or even load another script
+    while (isRunning() && m_Wait == EWait::None)
+    {
+        std::string line = m_Lines[m_NextLine++];
+        std::string result = m_Engine.getConsole().submitCommand(line);
+
+        if (result == "NOTFOUND")
+            LogWarn() << m_File << ": Unknown command or no world loaded: " << line;
+        else
+            LogInfo() << m_File << ": " << line << " -> " << result;
+    }
+
+    if (!isRunning() && m_Wait == EWait::None)
+        LogInfo() << "Console-script " << m_File << " done" << (m_HasFailed ? ", some measurements FAILED" : "");
+}
+
+bool ConsoleScript::isWaitDone()
+{
+    switch (m_Wait)
+    {
+        case EWait::Frames:
+            return m_WaitFrames == 0;
+
+        case EWait::Seconds:
+            return m_WaitRemaining <= 0.0;
+
+        case EWait::World:
+            return m_WaitFrames == 0
+                   && m_Engine.getMainWorld().isValid()
+                   && m_Engine.getHud().getLoadingScreen().isHidden()
+                   && m_Engine.getJobManager().getNumQueuedJobs() == 0
+                   && m_Engine.getJobManager().getNumAsyncJobs() == 0;
+
+        default:
+            return true;
+    }
+}
+
+std::string ConsoleScript::stopWindow(const std::string& name, const std::string& file)
+{
+    auto it = m_Windows.find(name);
+    if (it == m_Windows.end())
+        return "No measurement named " + name;
+
+    Window& w = it->second;
+
+    // In milliseconds from here on
+    std::vector<float> sorted = w.frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    for (float& t : sorted)
+        t *= 1000.0f;
+
+    size_t numFrames = sorted.size();
+    double sum = 0.0;
+    for (float t : sorted)
+        sum += t;
+
+    std::map<std::string, double> stats;
+    stats["avg"] = numFrames ? sum / numFrames : 0.0;
+    stats["p50"] = percentile(sorted, 50.0f);
+    stats["p90"] = percentile(sorted, 90.0f);
+    stats["p95"] = percentile(sorted, 95.0f);
+    stats["p99"] = percentile(sorted, 99.0f);
+    stats["max"] = sorted.empty() ? 0.0 : sorted.back();
+
+    json j;
+    j["name"] = name;
+    j["frames"] = numFrames;
+    j["seconds"] = w.duration;
+    j["world"] = m_Engine.getMainWorld().isValid() ? m_Engine.getMainWorld().get().getZenFile() : "";
+
+    for (const auto& s : stats)
+        j["frameTimeMs"][s.first] = s.second;
+
+    for (const auto& c : REPORTED_COUNTERS)
+    {
+        uint64_t total = m_Engine.getMetrics().getCounter(c.second) - w.counters[c.second];
+        double perFrame = numFrames ? static_cast<double>(total) / numFrames : 0.0;
+
+        j["counters"][c.first]["total"] = total;
+        j["counters"][c.first]["perFrame"] = perFrame;
+        stats[c.first] = perFrame;
+    }
+
+    bool passed = true;
+    j["limits"] = json::array();
+    for (const Limit& l : w.limits)
+    {
+        auto s = stats.find(l.stat);
+        if (s == stats.end())
+        {
+            LogWarn() << "Measurement " << name << ": Unknown stat '" << l.stat << "'";
+            continue;
+        }
+
+        bool ok = s->second <= l.value;
+        passed = passed && ok;
+
+        json jl;
+        jl["stat"] = l.stat;
+        jl["limit"] = l.value;
+        jl["value"] = s->second;
+        jl["passed"] = ok;
+        j["limits"].push_back(jl);
+    }
+
+    j["passed"] = passed;
+    m_HasFailed = m_HasFailed || !passed;
+
+    m_Windows.erase(it);
+
+    std::ofstream f(file);
+    if (!f)
+        return "Failed to write report to " + file;
+
+    f << j.dump(4);
+
+    std::stringstream ss;
+    ss << "Measurement " << name << ": " << numFrames << " frames, avg " << stats["avg"] << " ms, p95 " << stats["p95"]
+       << " ms, max " << stats["max"] << " ms -> " << (passed ? "passed" : "FAILED") << " (" << file << ")";
+
+    return ss.str();
+}
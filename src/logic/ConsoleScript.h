@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <engine/MetricsServer.h>
+
+namespace Engine
+{
+    class BaseEngine;
+}
+
+namespace Logic
+{
+    class Console;
+
+    /**
+     * Runs files of console-commands, one command per line, so performance-scenarios can be written
+     * without touching any code. Besides every regular console-command, scripts can use:
+     *
+     *  - wait frames <n>, wait seconds <s>: Pause the script
+     *  - wait world: Pause until a world is loaded, ie. after "switchlevel"
+     *  - measure start <name>: Open a measurement-window
+     *  - measure limit <name> <stat> <value>: Fail the window if the stat goes above the value.
+     *    Stats are avg, p50, p90, p95, p99 and max frametime in ms, or a counter per frame
+     *    (raytraces, sweeps, scriptcalls)
+     *  - measure stop <name> [file]: Close the window and write its report, <name>.perf.json by default
+     *
+     * Empty lines and lines starting with '#' are skipped. The frame-pacer is off while a script runs or a
+     * window is open, so the measured frametimes are those of the engine, not of --max-fps or --background-fps.
+     */
+    class ConsoleScript
+    {
+    public:
+        ConsoleScript(Engine::BaseEngine& e);
+
+        /**
+         * Adds the script-commands listed above to the given console
+         */
+        void registerCommands(Console& console);
+
+        /**
+         * Loads the given file and starts running it with the next frame. Replaces the script running before.
+         * @return Whether the file could be read
+         */
+        bool load(const std::string& file);
+
+        /**
+         * Records the last frame into all open measurement-windows and runs commands until the script waits
+         * @param dt Frametime in seconds, not scaled by the game-speed
+         */
+        void onFrame(double dt);
+
+        /**
+         * @return Whether there are still commands left to run
+         */
+        bool isRunning() const { return m_NextLine < m_Lines.size(); }
+
+        /**
+         * @return Whether any measurement-window is open
+         */
+        bool isMeasuring() const { return !m_Windows.empty(); }
+
+        /**
+         * @return Whether any window went over one of its limits
+         */
+        bool hasFailed() const { return m_HasFailed; }
+
+    private:
+        enum class EWait
+        {
+            None,
+            Frames,
+            Seconds,
+            World
+        };
+
+        struct Limit
+        {
+            std::string stat;
+            double value;
+        };
+
+        struct Window
+        {
+            std::vector<float> frameTimes;
+            double duration;
+            uint64_t counters[Engine::MetricsServer::C_NumCounters];
+            std::vector<Limit> limits;
+        };
+
+        /**
+         * Closes the given window and writes its report
+         * @return Message for the console
+         */
+        std::string stopWindow(const std::string& name, const std::string& file);
+
+        /**
+         * @return Whether the current wait is over
+         */
+        bool isWaitDone();
+
+        std::vector<std::string> m_Lines;
+        size_t m_NextLine;
+        std::string m_File;
+
+        EWait m_Wait;
+        double m_WaitRemaining;
+        size_t m_WaitFrames;
+
+        std::map<std::string, Window> m_Windows;
+        bool m_HasFailed;
+
+        Engine::BaseEngine& m_Engine;
+    };
+}
@@ -1,4 +1,5 @@
 #include "Inventory.h"
+#include <algorithm>
 #include "PlayerController.h"
 #include "ScriptEngine.h"
 #include <components/VobClasses.h>
@@ -21,9 +22,79 @@ Daedalus::GameState::ItemHandle Inventory::addItem(size_t sym, unsigned int coun
     // Get script-engine
     Logic::ScriptEngine& vm = m_World.getScriptEngine();
 
+    // Merge with the ones not created yet
+    auto it = m_SharedItems.find(sym);
+    if (it != m_SharedItems.end())
+    {
+        count += it->second;
+        m_SharedItems.erase(it);
+    }
+
     return vm.getGameState().createInventoryItem(sym, m_NPC, count);
 }
 
+void Inventory::addSharedItem(size_t sym, unsigned int count)
+{
+    Logic::ScriptEngine& vm = m_World.getScriptEngine();
+
+    using Daedalus::GEngineClasses::C_Item;
+    const C_Item& prototype = vm.getItemPrototype(sym);
+
+    // These are equipped by ScriptEngine::onInventoryItemInserted, which needs the actual item.
+    // Same if there already is one, they stack.
+    bool isEquipment = (prototype.mainflag & (C_Item::ITM_CAT_ARMOR | C_Item::ITM_CAT_NF | C_Item::ITM_CAT_FF)) != 0;
+    if (isEquipment || findItem(sym).isValid())
+    {
+        addItem(sym, count);
+        return;
+    }
+
+    m_SharedItems[sym] += count;
+}
+
+Daedalus::GameState::ItemHandle Inventory::materialize(size_t sym)
+{
+    auto it = m_SharedItems.find(sym);
+    if (it == m_SharedItems.end())
+        return Daedalus::GameState::ItemHandle();
+
+    unsigned int count = it->second;
+    m_SharedItems.erase(it);
+
+    return m_World.getScriptEngine().getGameState().createInventoryItem(sym, m_NPC, count);
+}
+
+void Inventory::shareCreatedItems()
+{
+    Logic::ScriptEngine& vm = m_World.getScriptEngine();
+
+    using Daedalus::GEngineClasses::C_Item;
+
+    // Copy, since we're removing from it
+    std::list<Daedalus::GameState::ItemHandle> items = vm.getGameState().getInventoryOf(m_NPC);
+
+    for (Daedalus::GameState::ItemHandle h : items)
+    {
+        C_Item& data = vm.getGameState().getItem(h);
+
+        // May have been equipped by the script already
+        if ((data.mainflag & (C_Item::ITM_CAT_ARMOR | C_Item::ITM_CAT_NF | C_Item::ITM_CAT_FF)) != 0)
+            continue;
+
+        size_t sym = data.instanceSymbol;
+        unsigned int count = data.amount;
+
+        vm.getGameState().removeInventoryItem(sym, m_NPC, count);
+        m_SharedItems[sym] += count;
+    }
+}
+
+void Inventory::materializeAll()
+{
+    while (!m_SharedItems.empty())
+        materialize(m_SharedItems.begin()->first);
+}
+
 Daedalus::GameState::ItemHandle Inventory::addItem(const std::string& symName, unsigned int count)
 {
     // Get script-engine
@@ -37,17 +108,41 @@ const std::list<Daedalus::GameState::ItemHandle>& Inventory::getItems()
     // Get script-engine
     Logic::ScriptEngine& vm = m_World.getScriptEngine();
 
+    // Callers want handles to everything
+    materializeAll();
+
     return vm.getGameState().getInventoryOf(m_NPC);
 }
 
 bool Inventory::removeItem(const std::string& symName, unsigned int count)
 {
-    return removeItem(getItem(symName), count);
+    Logic::ScriptEngine& vm = m_World.getScriptEngine();
+
+    return removeItem(vm.getSymbolIndexByName(symName), count);
 }
 
 bool Inventory::removeItem(size_t symIndex, unsigned int count)
 {
-    return removeItem(getItem(symIndex), count);
+    if (getItemCount(symIndex) < count)
+        return false;
+
+    // Items without script-instance are simply not counted anymore. Take those first.
+    auto it = m_SharedItems.find(symIndex);
+    if (it != m_SharedItems.end())
+    {
+        unsigned int shared = std::min(it->second, count);
+
+        it->second -= shared;
+        count -= shared;
+
+        if (it->second == 0)
+            m_SharedItems.erase(it);
+    }
+
+    if (count == 0)
+        return true;
+
+    return removeItem(findItem(symIndex), count);
 }
 
 bool Inventory::removeItem(Daedalus::GameState::ItemHandle item, unsigned int count)
@@ -73,10 +168,19 @@ bool Inventory::removeItem(Daedalus::GameState::ItemHandle item, unsigned int co
 }
 
 Daedalus::GameState::ItemHandle Inventory::getItem(size_t symIndex)
+{
+    Daedalus::GameState::ItemHandle h = materialize(symIndex);
+    if (h.isValid())
+        return h;
+
+    return findItem(symIndex);
+}
+
+Daedalus::GameState::ItemHandle Inventory::findItem(size_t symIndex)
 {
     // Get script-engine
     Logic::ScriptEngine& vm = m_World.getScriptEngine();
-    const std::list<Daedalus::GameState::ItemHandle>& items = getItems();
+    const std::list<Daedalus::GameState::ItemHandle>& items = vm.getGameState().getInventoryOf(m_NPC);
 
     for (Daedalus::GameState::ItemHandle h : items)
     {
@@ -105,9 +209,13 @@ Daedalus::GEngineClasses::C_Item& Inventory::getItem(Daedalus::GameState::ItemHa
 
 unsigned int Inventory::getItemCount(size_t symIndex)
 {
-    Daedalus::GameState::ItemHandle item = getItem(symIndex);
+    unsigned int count = getItemCount(findItem(symIndex));
+
+    auto it = m_SharedItems.find(symIndex);
+    if (it != m_SharedItems.end())
+        count += it->second;
 
-    return getItemCount(item);
+    return count;
 }
 
 unsigned int Inventory::getItemCount(Daedalus::GameState::ItemHandle item)
@@ -125,7 +233,7 @@ void Inventory::exportInventory(json& j)
     // Get script-engine
     Logic::ScriptEngine& vm = m_World.getScriptEngine();
 
-    for (auto item : getItems())
+    for (auto item : vm.getGameState().getInventoryOf(m_NPC))
     {
         Daedalus::GEngineClasses::C_Item& data = vm.getGameState().getItem(item);
         std::string instanceName = vm.getVM().getDATFile().getSymbolByIndex(data.instanceSymbol).name;
@@ -133,6 +241,10 @@ void Inventory::exportInventory(json& j)
         // Save instance and amount. Rest will be initialized by script on loading
         j[instanceName] = data.amount;
     }
+
+    // No need to create the others just for this
+    for (const auto& shared : m_SharedItems)
+        j[vm.getVM().getDATFile().getSymbolByIndex(shared.first).name] = shared.second;
 }
 
 void Inventory::importInventory(const json& j)
@@ -140,9 +252,11 @@ void Inventory::importInventory(const json& j)
     // Make sure the item is empty
     clear();
 
+    Logic::ScriptEngine& vm = m_World.getScriptEngine();
+
     for (auto it = j.begin(); it != j.end(); it++)
     {
-        addItem(it.key(), it.value());
+        addSharedItem(vm.getSymbolIndexByName(it.key()), it.value());
     }
 }
 
@@ -151,6 +265,8 @@ void Inventory::clear()
     // Get script-engine
     Logic::ScriptEngine& vm = m_World.getScriptEngine();
 
+    m_SharedItems.clear();
+
     auto items = getItems();
 
     // Remove all items
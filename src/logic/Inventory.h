@@ -1,4 +1,5 @@
 #pragma once
+#include <map>
 #include <json.hpp>
 #include <daedalus/DaedalusGameState.h>
 #include <handle/HandleDef.h>
@@ -12,6 +13,11 @@ namespace World
 
 namespace Logic
 {
+    /**
+     * Items carried by an NPC. Items added by scripts don't get their own script-instance right away, but are only
+     * counted by instance and share the prototype kept by the ScriptEngine. Most of them are never looked at before
+     * the NPC dies or the game is saved. The actual instance is created once something asks for a handle to the item.
+     */
     class Inventory
     {
     public:
@@ -26,6 +32,19 @@ namespace Logic
         Daedalus::GameState::ItemHandle addItem(const std::string& symName, unsigned int count = 1);
         Daedalus::GameState::ItemHandle addItem(size_t sym, unsigned int count = 1);
 
+        /**
+         * Adds items without creating their script-instance. Weapons and armor are still created right away,
+         * since they get equipped on insertion.
+         * @param sym Script instance of the item
+         */
+        void addSharedItem(size_t sym, unsigned int count = 1);
+
+        /**
+         * Drops the script-instances of all items nothing but the script-constructor of the NPC has touched and
+         * only counts them from then on. To be called once the script-constructor of the NPC has run.
+         */
+        void shareCreatedItems();
+
         /**
          * Removes an item of the given instance from the inventory
          * @param symName Instance to remove
@@ -79,6 +98,23 @@ namespace Logic
         void importInventory(const json& j);
 
     protected:
+        /**
+         * Creates the script-instance of items only counted in m_SharedItems so far
+         * @return Handle to the created item. Invalid if there were none of the given instance.
+         */
+        Daedalus::GameState::ItemHandle materialize(size_t sym);
+        void materializeAll();
+
+        /**
+         * @return Handle to the item of the given instance, without creating it. Invalid if it has no script-instance.
+         */
+        Daedalus::GameState::ItemHandle findItem(size_t symIndex);
+
+        /**
+         * Items which are still exactly like their prototype, by instance symbol, with their count
+         */
+        std::map<size_t, unsigned int> m_SharedItems;
+
         /**
          * NPC this inventory belongs to
          */
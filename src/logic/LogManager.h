@@ -45,6 +45,11 @@ namespace Logic
          */
         void importLogManager(const json& log);
 
+        /**
+         * Removes all topics and entries
+         */
+        void clear() { m_PlayerLog.clear(); }
+
         /**
          * Imports a single mission-topic or note-topic
          */
@@ -372,8 +372,6 @@ void NpcAIHandler::playerUpdate(float deltaTime)
     }
 
      */
-
-    resetKeyStates();
 }
 
 void NpcAIHandler::onAction(Engine::ActionType actionType, bool triggered)
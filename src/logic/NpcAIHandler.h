@@ -75,6 +75,11 @@ namespace Logic
         void onAction(Engine::ActionType actionType, bool triggered);
         void unbindKeys();
 
+        /**
+         * Resets the players input. Used after input was processed by all logic-ticks of a frame.
+         */
+        void resetKeyStates();
+
         /**
          * @param state Movementstate to set for AI
          */
@@ -91,10 +96,6 @@ namespace Logic
         NpcAnimationHandler& getNpcAnimationHandler() const;
 
     private:
-        /**
-         * Resets the players input. Used after input was processed...
-         */
-        void resetKeyStates();
 
         /**
          * Movement-directions
@@ -0,0 +1,187 @@
+#include "NpcPool.h"
+#include <algorithm>
+#include <components/AnimHandler.h>
+#include <components/EntityActions.h>
+#include <components/Vob.h>
+#include <components/VobClasses.h>
+#include <engine/World.h>
+#include <logic/PlayerController.h>
+#include <logic/visuals/ModelVisual.h>
+#include <utils/cli.h>
+#include <utils/logger.h>
+
+using namespace Logic;
+
+namespace Flags
+{
+    Cli::Flag npcPoolSize("", "npc-pool-size", 1, "Number of removed NPCs kept around per world, to be reused by newly inserted ones. 0 disables pooling.", {"32"}, "Game");
+}
+
+/**
+ * Pooled NPCs are moved here, so they are outside of any update- and draw-range
+ */
+const Math::float3 NPC_POOL_PARKING_POSITION = Math::float3(0.0f, -100000.0f, 0.0f);
+
+namespace
+{
+    /**
+     * Scripts don't care about the case of visual names
+     */
+    std::string toUpper(std::string s)
+    {
+        std::transform(s.begin(), s.end(), s.begin(), ::toupper);
+        return s;
+    }
+}
+
+NpcPool::NpcPool(World::WorldInstance& world)
+    : m_NumPooled(0)
+    , m_MaxPooled(0)
+    , m_World(world)
+{
+    m_MaxPooled = static_cast<size_t>(std::max(0, atoi(Flags::npcPoolSize.getParam(0).c_str())));
+}
+
+bool NpcPool::beginSetup(Handle::EntityHandle npc)
+{
+    if (m_MaxPooled == 0)
+        return false;
+
+    m_Setup[npc] = "";
+    return true;
+}
+
+bool NpcPool::deferModelScript(Handle::EntityHandle npc, const std::string& meshLib)
+{
+    auto it = m_Setup.find(npc);
+    if (it == m_Setup.end())
+        return false;
+
+    it->second = meshLib;
+    return true;
+}
+
+bool NpcPool::endSetup(Handle::EntityHandle npc, const std::string& bodyMesh, std::string& meshLib)
+{
+    meshLib.clear();
+
+    auto it = m_Setup.find(npc);
+    if (it == m_Setup.end())
+        return false;
+
+    meshLib = it->second;
+    m_Setup.erase(it);
+
+    if (meshLib.empty() || bodyMesh.empty())
+        return true;
+
+    Handle::EntityHandle shell = acquire(meshLib, bodyMesh);
+    if (shell.isValid())
+        moveShellVisual(shell, npc);
+
+    return true;
+}
+
+Handle::EntityHandle NpcPool::acquire(const std::string& meshLib, const std::string& bodyMesh)
+{
+    auto shellIt = m_Shells.find(ShellKey(toUpper(meshLib), toUpper(bodyMesh)));
+    if (shellIt == m_Shells.end() || shellIt->second.empty())
+    {
+        m_Stats.misses++;
+        return Handle::EntityHandle::makeInvalidHandle();
+    }
+
+    Handle::EntityHandle e = shellIt->second.back();
+    shellIt->second.pop_back();
+    m_NumPooled--;
+
+    if (!m_World.isEntityValid(e))
+    {
+        m_Stats.misses++;
+        return Handle::EntityHandle::makeInvalidHandle();
+    }
+
+    m_Stats.hits++;
+    return e;
+}
+
+void NpcPool::moveShellVisual(Handle::EntityHandle shell, Handle::EntityHandle npc)
+{
+    Components::ComponentAllocator& alloc = m_World.getComponentAllocator();
+
+    Components::VisualComponent& shellVisual = m_World.getEntity<Components::VisualComponent>(shell);
+    Components::VisualComponent& npcVisual = Components::Actions::initComponent<Components::VisualComponent>(alloc, npc);
+
+    Components::AnimationComponent& shellAnim = m_World.getEntity<Components::AnimationComponent>(shell);
+    Components::AnimationComponent& npcAnim = Components::Actions::initComponent<Components::AnimationComponent>(alloc, npc);
+
+    // The NPC doesn't have a visual during setup, this only frees what might have been set by a script anyways
+    delete npcVisual.m_pVisualController;
+    npcVisual.m_pVisualController = shellVisual.m_pVisualController;
+    shellVisual.m_pVisualController = nullptr;
+
+    delete npcAnim.m_AnimHandler;
+    npcAnim.m_AnimHandler = shellAnim.m_AnimHandler;
+    shellAnim.m_AnimHandler = nullptr;
+
+    reinterpret_cast<ModelVisual*>(npcVisual.m_pVisualController)->setHostEntity(npc);
+
+    m_World.removeEntity(shell);
+}
+
+bool NpcPool::release(Handle::EntityHandle npc)
+{
+    if (m_MaxPooled == 0)
+        return false;
+
+    m_Setup.erase(npc);
+
+    if (m_NumPooled >= m_MaxPooled)
+    {
+        m_Stats.discarded++;
+        return false;
+    }
+
+    VobTypes::NpcVobInformation vob = VobTypes::asNpcVob(m_World, npc);
+    if (!vob.isValid() || !vob.playerController)
+        return false;
+
+    ModelVisual* model = vob.playerController->getModelVisual();
+    Components::EntityComponent& entity = m_World.getEntity<Components::EntityComponent>(npc);
+
+    if (!model || !Components::hasComponent<Components::AnimationComponent>(entity))
+        return false;
+
+    Components::AnimHandler& animHandler = m_World.getEntity<Components::AnimationComponent>(npc).getAnimHandler();
+    ShellKey key = {toUpper(animHandler.getMeshLibName()), toUpper(model->getBodyState().bodyVisual)};
+
+    // The controller holds all AI- and script-state. That is cheap to rebuild compared to the visual,
+    // so it gets recreated once the shell is reused.
+    VobTypes::unlinkNPCFromScriptInstance(m_World, npc, vob.playerController->getScriptHandle());
+    Components::Actions::Logic::destroyLogicComponent(m_World.getEntity<Components::LogicComponent>(npc));
+
+    // Drop whatever the NPC was carrying. Animation-callbacks would still point to the deleted controller.
+    model->clearAttachments();
+    animHandler.setOverlay("");
+    animHandler.stopAnimation();
+    animHandler.setCallbackEventSFX(nullptr);
+    animHandler.setCallbackEventSFXGround(nullptr);
+    animHandler.setCallbackEventTag(nullptr);
+    animHandler.setCallbackEventPfx(nullptr);
+    animHandler.setCallbackEventPfxStop(nullptr);
+
+    Vob::VobInformation shell = Vob::asVob(m_World, npc);
+    Vob::setPosition(shell, NPC_POOL_PARKING_POSITION);
+
+    m_Shells[key].push_back(npc);
+    m_NumPooled++;
+    m_Stats.released++;
+
+    return true;
+}
+
+void NpcPool::getPooledEntities(std::set<Handle::EntityHandle>& entities) const
+{
+    for (const auto& s : m_Shells)
+        entities.insert(s.second.begin(), s.second.end());
+}
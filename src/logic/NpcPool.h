@@ -0,0 +1,118 @@
+#pragma once
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <handle/HandleDef.h>
+
+namespace World
+{
+    class WorldInstance;
+}
+
+namespace Logic
+{
+    /**
+     * Keeps the entities of removed NPCs around, so the next NPC using the same model doesn't have to load
+     * its meshes, animations and attachments again. Shells are keyed by model script and body mesh.
+     *
+     * Both are only known once the script constructor of a new NPC has set them. Until then, the NPC has no visual
+     * and its model script is held back. Once the body mesh follows, the visual of a matching shell is moved over.
+     */
+    class NpcPool
+    {
+    public:
+        struct Stats
+        {
+            /**
+             * Inserted NPCs which could/couldn't reuse a pooled shell
+             */
+            size_t hits = 0;
+            size_t misses = 0;
+
+            /**
+             * Removed NPCs which were put into the pool/had to be destroyed because the pool was full
+             */
+            size_t released = 0;
+            size_t discarded = 0;
+        };
+
+        NpcPool(World::WorldInstance& world);
+
+        /**
+         * Marks the given NPC as freshly inserted, before its script constructor runs
+         * @return Whether pooling is enabled. If so, the NPC must not get a visual until its setup has ended.
+         */
+        bool beginSetup(Handle::EntityHandle npc);
+
+        /**
+         * Remembers the model script of an NPC which is still being set up, instead of loading it
+         * @param meshLib Model script without extension, ie. "HUMANS"
+         * @return Whether the NPC is being set up. If not, the model script has to be loaded as usual.
+         */
+        bool deferModelScript(Handle::EntityHandle npc, const std::string& meshLib);
+
+        /**
+         * Ends the setup of the given NPC. If a pooled shell matches its model script and body mesh,
+         * the visual and animations of that shell are moved over to the NPC.
+         * @param bodyMesh Body mesh of the NPC, empty if its script didn't set one
+         * @param meshLib [out] Model script held back for the NPC, which still has to be set on it. Empty if there is none.
+         * @return Whether the NPC was being set up
+         */
+        bool endSetup(Handle::EntityHandle npc, const std::string& bodyMesh, std::string& meshLib);
+
+        /**
+         * Strips the given NPC down to its visual and animation state and parks it inside the pool.
+         * Must be called while the script instance of the NPC is still valid.
+         * @param npc NPC to put into the pool
+         * @return Whether the NPC was taken. If false, it must be removed from the world as usual.
+         */
+        bool release(Handle::EntityHandle npc);
+
+        /**
+         * @param entities [out] Set to put the pooled shells into
+         */
+        void getPooledEntities(std::set<Handle::EntityHandle>& entities) const;
+
+        /**
+         * @return Number of shells currently inside the pool
+         */
+        size_t getNumPooled() const { return m_NumPooled; }
+
+        /**
+         * @return Hit/miss counters
+         */
+        const Stats& getStats() const { return m_Stats; }
+
+    private:
+        /**
+         * Model script (mesh lib) and body mesh
+         */
+        typedef std::pair<std::string, std::string> ShellKey;
+
+        /**
+         * @return A pooled shell using the given model script and body mesh, or an invalid handle.
+         *         The shell has no logic controller set, but keeps its model visual and animations.
+         */
+        Handle::EntityHandle acquire(const std::string& meshLib, const std::string& bodyMesh);
+
+        /**
+         * Moves the visual and animations of the given shell over to the NPC and removes the shell
+         */
+        void moveShellVisual(Handle::EntityHandle shell, Handle::EntityHandle npc);
+
+        std::map<ShellKey, std::vector<Handle::EntityHandle>> m_Shells;
+
+        /**
+         * NPCs being set up by their script constructor, with the model script held back for them
+         */
+        std::map<Handle::EntityHandle, std::string> m_Setup;
+
+        size_t m_NumPooled;
+        size_t m_MaxPooled;
+
+        Stats m_Stats;
+
+        World::WorldInstance& m_World;
+    };
+}
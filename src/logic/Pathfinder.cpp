@@ -3,6 +3,7 @@
 //
 
 #include "Pathfinder.h"
+#include <engine/RouteCache.h>
 #include <engine/World.h>
 #include <debugdraw/debugdraw.h>
 #include <stdlib.h>
@@ -278,7 +279,7 @@ void Pathfinder::startNewRouteTo(const Math::float3& positionNow, const Math::fl
     Waynet::WaypointIndex nearestWpToTarget = Waynet::findNearestWaypointTo(m_World.getWaynet(), position);
     Waynet::WaypointIndex nearestWpToStart = Waynet::findNearestWaypointTo(m_World.getWaynet(), positionNow);
 
-    std::vector<Waynet::WaypointIndex> path = Waynet::findWay(m_World.getWaynet(), nearestWpToStart, nearestWpToTarget);
+    std::vector<Waynet::WaypointIndex> path = m_World.getRouteCache().findWay(nearestWpToStart, nearestWpToTarget);
 
     for(Waynet::WaypointIndex i : path)
     {
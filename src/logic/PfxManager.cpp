@@ -3,17 +3,84 @@
 //
 
 #include "PfxManager.h"
+#include <algorithm>
 #include <map>
 #include <ZenLib/utils/logger.h>
 #include <daedalus/DaedalusVM.h>
 #include <engine/BaseEngine.h>
 #include <engine/World.h>
 #include <utils/Utils.h>
+#include <utils/cli.h>
+
+namespace Flags
+{
+    Cli::Flag pfxParticleBudget("", "pfx-particle-budget", 1, "Maximum number of live particles per world. 0 means unlimited.", {"20000"}, "Rendering");
+}
+
+/**
+ * Share of the particle-budget emitters of the given priority may fill up
+ */
+const float PFX_BUDGET_SHARE_LOW = 0.5f;
+const float PFX_BUDGET_SHARE_NORMAL = 0.85f;
+const float PFX_BUDGET_SHARE_HIGH = 1.0f;
 
 Logic::PfxManager::PfxManager(World::WorldInstance& world)
     : m_pVM(nullptr)
     , m_World(world)
+    , m_NumGrantedThisTick(0)
+    , m_Frame(0)
+    , m_ParticleBudget(0)
+{
+    m_ParticleBudget = static_cast<size_t>(std::max(0, atoi(Flags::pfxParticleBudget.getParam(0).c_str())));
+}
+
+void Logic::PfxManager::onFrameStart()
+{
+    m_Frame++;
+}
+
+void Logic::PfxManager::onTickStart()
+{
+    m_LastTickStats = m_TickStats;
+    m_TickStats = ParticleStats();
+    m_NumGrantedThisTick = 0;
+}
+
+size_t Logic::PfxManager::requestParticles(size_t num, EPriority priority)
+{
+    if (m_ParticleBudget == 0)
+        return num;
+
+    float share;
+    switch (priority)
+    {
+        case PP_Low:
+            share = PFX_BUDGET_SHARE_LOW;
+            break;
+        case PP_High:
+            share = PFX_BUDGET_SHARE_HIGH;
+            break;
+        default:
+            share = PFX_BUDGET_SHARE_NORMAL;
+            break;
+    }
+
+    // Particles alive right now are estimated from the last tick
+    size_t live = m_LastTickStats.simulated + m_LastTickStats.skipped + m_NumGrantedThisTick;
+    size_t limit = static_cast<size_t>(m_ParticleBudget * share);
+    size_t available = limit > live ? limit - live : 0;
+    size_t granted = std::min(num, available);
+
+    m_NumGrantedThisTick += granted;
+    m_TickStats.culled += num - granted;
+
+    return granted;
+}
+
+void Logic::PfxManager::reportParticles(size_t numSimulated, size_t numSkipped)
 {
+    m_TickStats.simulated += numSimulated;
+    m_TickStats.skipped += numSkipped;
 }
 
 Logic::PfxManager::~PfxManager()
@@ -169,9 +169,69 @@ namespace Logic
             bool isAmbientPFX;                     // Not rendered if the player choose to not render AmbientPFX in the games settings
         };
 
+        /**
+         * Who gets particles first, once the particle-budget runs short
+         */
+        enum EPriority
+        {
+            PP_Low,     // Ambient effects
+            PP_Normal,  // Everything else
+            PP_High,    // Effects caused by the player
+        };
+
+        /**
+         * Particle counters of the last logic-tick
+         */
+        struct ParticleStats
+        {
+            size_t simulated = 0;  // Particles of visible emitters
+            size_t skipped = 0;    // Particles of emitters which were out of view
+            size_t culled = 0;     // Particles which were not spawned because of the budget
+        };
+
         PfxManager(World::WorldInstance& world);
         ~PfxManager();
 
+        /**
+         * Advances the frame-counter used for visibility. To be called once per rendered frame, not per logic-tick.
+         */
+        void onFrameStart();
+
+        /**
+         * Resets the particle counters. Particles are spawned and simulated in logic-ticks, so these are counted per tick.
+         */
+        void onTickStart();
+
+        /**
+         * @return Number of the current rendered frame
+         */
+        uint32_t getFrame() const { return m_Frame; }
+
+        /**
+         * Asks the budget for new particles
+         * @param num Number of particles the emitter wants to spawn
+         * @param priority Priority of the emitter
+         * @return Number of particles the emitter may actually spawn
+         */
+        size_t requestParticles(size_t num, EPriority priority);
+
+        /**
+         * Adds to the counters of this tick
+         * @param numSimulated Particles of an emitter which got simulated
+         * @param numSkipped Particles of an emitter which were left alone, since they are out of view
+         */
+        void reportParticles(size_t numSimulated, size_t numSkipped);
+
+        /**
+         * @return Counters of the last finished logic-tick
+         */
+        const ParticleStats& getParticleStats() const { return m_LastTickStats; }
+
+        /**
+         * @return Maximum number of live particles. 0 if unlimited.
+         */
+        size_t getParticleBudget() const { return m_ParticleBudget; }
+
         /**
          * Checks whether the given pfx-instance exists
          * @param name instance to check
@@ -212,5 +272,23 @@ namespace Logic
          * Default emitter to return if an invalid one was requested
          */
         Emitter m_DefaultEmitter;
+
+        /**
+         * Particle-counters of the current and last tick
+         */
+        ParticleStats m_TickStats;
+        ParticleStats m_LastTickStats;
+
+        /**
+         * Particles handed out by requestParticles() in this tick
+         */
+        size_t m_NumGrantedThisTick;
+
+        /**
+         * Counts the calls to onFrameStart()
+         */
+        uint32_t m_Frame;
+
+        size_t m_ParticleBudget;
     };
 }
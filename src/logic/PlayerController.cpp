@@ -6,6 +6,7 @@
 #include "ItemController.h"
 #include "MobController.h"
 #include "CameraController.h"
+#include <cmath>
 #include <json.hpp>
 #include <stdlib.h>
 #include "visuals/ModelVisual.h"
@@ -16,6 +17,8 @@
 #include <debugdraw/debugdraw.h>
 #include <engine/BaseEngine.h>
 #include <engine/Input.h>
+#include <engine/LightProbeGrid.h>
+#include <engine/LooseItems.h>
 #include <engine/Waynet.h>
 #include <engine/World.h>
 #include <engine/WorldMesh.h>
@@ -87,15 +90,12 @@ PlayerController::PlayerController(World::WorldInstance& world,
     , m_AIHandler(world, entity)
     , m_PathFinder(world)
     , m_CharacterEquipment(world, entity)
+    , m_CharacterController(world.getPhysicsSystem())
 {
     m_NPCProperties.enablePhysics = true;
 
     m_MoveState.direction = Math::float3(1, 0, 0);
     m_MoveState.position = Math::float3(0, 0, 0);
-    m_MoveState.ground.successful = false;
-    m_MoveState.ground.triangleIndex = 0;
-    m_MoveState.ground.waterDepth = 0;
-    m_MoveState.ground.trianglePosition = Math::float3(0, 0, 0);
 
     m_ScriptState.npcHandle = scriptInstance;
 
@@ -106,6 +106,7 @@ PlayerController::PlayerController(World::WorldInstance& world,
 
     m_LastAniRootPosUpdatedAniHash = 0;
     m_NoAniRootPosHack = false;
+    m_LastShadowValue = -1.0f;
 
     setBodyState(BS_STAND);
 }
@@ -138,23 +139,22 @@ void PlayerController::onUpdate(float deltaTime)
         // Update model for this frame
         model->onFrameUpdate(deltaTime);
 
-        // Retrieve data of the ground on which the NPC is standing
-        traceDownNPCGround();
-
-        // Needs to be done here to account for changes of feet-height
-        placeOnGround();
-
         Animations::Animation* activeAnim = getModelVisual()->getAnimationHandler().getActiveAnimationPtr();
-        if (!m_NoAniRootPosHack && activeAnim)
+        bool applyRootMotion = !m_NoAniRootPosHack && activeAnim;
+
+        // Apply model root-velcoity
+        Math::float3 motion(0, 0, 0);
+        if (applyRootMotion && (activeAnim->m_Flags & Animations::Animation::MSB_FLAG_MOVE_MODEL))
         {
-            // Apply model root-velcoity
-            if (activeAnim->m_Flags & Animations::Animation::MSB_FLAG_MOVE_MODEL)
-            {
-                // Move by translation-velocity
-                m_MoveState.position += getEntityTransform().Rotate(
-                    getModelVisual()->getAnimationHandler().getRootNodeVelocity());
-            }
+            // Move by translation-velocity
+            motion = getEntityTransform().Rotate(getModelVisual()->getAnimationHandler().getRootNodeVelocity());
+        }
 
+        // Needs to be done every frame to account for changes of feet-height. Also updates the ground below the NPC.
+        placeOnGround(motion);
+
+        if (applyRootMotion)
+        {
             //bgfx::dbgTextPrintf(0,5, 0x2, "Vel: %s", getModelVisual()->getAnimationHandler().getRootNodeVelocity().toString().c_str());
 
             Math::Matrix t = getEntityTransform();
@@ -198,7 +198,9 @@ void PlayerController::teleportToPosition(const Math::float3& pos)
     // This also update the entity transform from m_MoveState.position
     setDirection(m_MoveState.direction);
 
-    placeOnGround();
+    // The position is either on the ground or at the center of the NPC. Searching from the feet upwards works for both.
+    if (m_NPCProperties.enablePhysics)
+        placeFeetOnGround(pos, Math::float3(0, 0, 0));
 
     // Start with idle-animation
     //getModelVisual()->setAnimation(ModelVisual::Idle);
@@ -359,17 +361,11 @@ ModelVisual* PlayerController::getModelVisual()
     return reinterpret_cast<ModelVisual*>(vob.visual);
 }
 
-void PlayerController::placeOnSurface(const Physics::RayTestResult& hit)
+float PlayerController::getFeetHeight()
 {
-    if (DEBUG_PLAYER)
-    {
-        LogInfo() << (int)m_World.getWorldMesh().getMaterialGroupOfTriangle(hit.hitTriangleIndex)
-                  << ", Placing hero at position: "
-                  << hit.hitPosition.x << ", " << hit.hitPosition.y << ", " << hit.hitPosition.z;
-    }
-    Math::Matrix m = getEntityTransform();
-
-    float feet = getModelVisual()->getModelRoot().y;
+    // NPCs taking their visual from the NPC-pool don't have one until their script constructor has set it up
+    ModelVisual* model = getModelVisual();
+    float feet = model ? model->getModelRoot().y : 0.0f;
 
     // FIXME: Actually read the flying-flag of the MDS
     if (feet == 0.0f)
@@ -377,124 +373,57 @@ void PlayerController::placeOnSurface(const Physics::RayTestResult& hit)
         feet = 0.9762f;  // FIXME: Boundingbox of the animation or something should be used instead
     }
 
-    m_MoveState.position = hit.hitPosition + Math::float3(0.0f, feet, 0.0f);
-    m.Translation(m_MoveState.position);
-    setEntityTransform(m);
-    setDirection(m_MoveState.direction);
+    return feet;
 }
 
-void PlayerController::placeOnGround()
+void PlayerController::placeFeetOnGround(const Math::float3& feet, const Math::float3& motion)
 {
-    if (!m_NPCProperties.enablePhysics)
-        return;
-
-    // Check for states
-    /*switch(getBodyState())
-    {
-        case bs_stand:break;
-        case bs_walk:break;
-        case bs_sneak:break;
-        case bs_run:break;
-        case bs_sprint:break;
-        case bs_swim:break;
-        case bs_crawl:break;
-        case bs_dive:break;
-        case bs_jump:break;
-        case bs_climb:break;
-        case bs_fall:break;
-        case bs_sit:break;
-        case bs_lie:break;
-        case bs_inventory:break;
-        case bs_iteminteract:break;
-        case bs_mobinteract:break;
-        case bs_mobinteract_interrupt:break;
-        case bs_takeitem:break;
-        case bs_dropitem:break;
-        case bs_throwitem:break;
-        case bs_pickpocket:break;
-        case bs_stumble:break;
-        case bs_unconscious:return; // animation takes care of that. would fall through the ground for some reason otherwise.
-        case bs_dead:break;
-        case bs_aimnear:break;
-        case bs_aimfar:break;
-        case bs_hit:break;
-        case bs_parade:break;
-        case bs_casting:break;
-        case bs_petrified:break;
-        case bs_controlling:break;
-        case bs_max:break;
-    }*/
-
-    // Fix position
-    Math::float3 entityPosition = getEntityTransform().Translation();
-    Math::float3 to = entityPosition + Math::float3(0.0f, -100.0f, 0.0f);
-    Math::float3 from = entityPosition + Math::float3(0.0f, 30.0f, 0.0f);
-
-    std::vector<Physics::RayTestResult> hitall = m_World.getPhysicsSystem().raytraceAll(from, to);
-    if (hitall.empty())
-        return;
-    std::sort(hitall.begin(), hitall.end(), [](const Physics::RayTestResult& a, const Physics::RayTestResult& b) {
-        return a.hitPosition.y > b.hitPosition.y;
-    });
+    Math::float3 newFeet = m_CharacterController.move(feet, motion);
 
-    bool fellThrough = true;
-    bool underWater = false;
-    bool aboveGround = false;
-    bool shallowWater = false;
-    float fallthroughEpsilon = 0.25f;  // Give a little room for animations, etc
-    Physics::RayTestResult highestHitSurface = hitall[0];
-    Physics::RayTestResult waterHitSurface = hitall[0];
-    Physics::RayTestResult closestHitGroundSurface = hitall[0];
-    float highestHitY = std::numeric_limits<float>::min();
-    float closestResult = std::numeric_limits<float>::max();
-    for (const auto& result : hitall)
+    if (DEBUG_PLAYER)
     {
-        fellThrough = fellThrough && (result.hitPosition.y - fallthroughEpsilon > entityPosition.y);  // for all results NPC's Y coordinate lower than result position Y coordinate
-        if (highestHitY < result.hitPosition.y)
-        {
-            highestHitY = result.hitPosition.y;
-            highestHitSurface = result;
-        }
-        auto material = m_World.getWorldMesh().getMaterialGroupOfTriangle(result.hitTriangleIndex);
-        if (result.hitFlags == Physics::CollisionShape::CT_Object) material = ZenLoad::MaterialGroup::UNDEF;  // we don't want underlying worldmesh material in this case
-        if (material == ZenLoad::MaterialGroup::WATER)
-        {
-            waterHitSurface = result;  // Doesn't matter if there are more water hits atm
-        }
-        float newDistance = 0.0f;
-        if ((newDistance = (std::abs(entityPosition.y - result.hitPosition.y))) < closestResult && material != ZenLoad::MaterialGroup::WATER)
-        {
-            closestHitGroundSurface = result;
-            closestResult = newDistance;
-        }
+        LogInfo() << (int)getSurfaceMaterial()
+                  << ", Placing hero at position: "
+                  << newFeet.x << ", " << newFeet.y << ", " << newFeet.z;
     }
 
-    auto manageState = [&]() {
-        if (fellThrough)
-        {
-            placeOnSurface(highestHitSurface);
-            return;
-        }
+    Math::Matrix m = getEntityTransform();
 
-        placeOnSurface(closestHitGroundSurface);
-    };
-    manageState();
-    //     // FIXME: Get rid of the second cast here or at least only do it on the worldmesh!
-    if (m_MoveState.ground.successful)
+    m_MoveState.position = newFeet + Math::float3(0.0f, getFeetHeight(), 0.0f);
+    m.Translation(m_MoveState.position);
+    setEntityTransform(m);
+    setDirection(m_MoveState.direction);
+
+    // Update color. Only touch the visual if the lighting actually changed.
+    float shadow = m_World.getLightProbeGrid().sample(m_MoveState.position);
+    if (getModelVisual() && std::abs(shadow - m_LastShadowValue) > 1.0f / 255.0f)
     {
-        // Update color
-        float shadow = m_World.getWorldMesh().interpolateTriangleShadowValue(m_MoveState.ground.triangleIndex, m_MoveState.ground.trianglePosition);
+        getModelVisual()->setShadowValue(shadow);
+        m_LastShadowValue = shadow;
+    }
+}
 
-        if (getModelVisual())
-            getModelVisual()->setShadowValue(shadow);
+void PlayerController::placeOnGround(const Math::float3& motion)
+{
+    if (!m_NPCProperties.enablePhysics)
+    {
+        m_MoveState.position += motion;
+        return;
     }
+
+    placeFeetOnGround(getEntityTransform().Translation() - Math::float3(0.0f, getFeetHeight(), 0.0f), motion);
 }
 
 void PlayerController::onVisualChanged()
 {
+    m_LastShadowValue = -1.0f;
+
     getModelVisual()->getCollisionBBox(m_NPCProperties.collisionBBox);
     m_NPCProperties.modelRoot = getModelVisual()->getModelRoot();
 
+    Math::float3 bboxSize = m_NPCProperties.collisionBBox[1] - m_NPCProperties.collisionBBox[0];
+    m_CharacterController.setRadius(0.5f * std::min(std::abs(bboxSize.x), std::abs(bboxSize.z)));
+
     getModelVisual()->setTransient(true);  // Don't export this from here. Will be rebuilt after loading anyways.
 
     // Setup callbacks
@@ -555,9 +484,6 @@ void PlayerController::onUpdateByInput(float deltaTime)
     if (m_MoveSpeed2)
         moveMod *= 16.0f;
 
-    m_MoveSpeed2 = false;
-    m_MoveSpeed1 = false;
-
     getModelVisual()->getAnimationHandler().setSpeedMultiplier(moveMod);
 
     m_AIHandler.playerUpdate(deltaTime);
@@ -1126,7 +1052,8 @@ void PlayerController::setDirection(const Math::float3& direction)
     // This is a hack present in the original game. If the charakter is sitting and one of the following animations
     // are played, the direction should be reversed
     Math::float3 d = m_MoveState.direction;
-    if (getModelVisual()->isAnimPlaying("S_BENCH_S1") || getModelVisual()->isAnimPlaying("S_THRONE_S1"))
+    ModelVisual* model = getModelVisual();
+    if (model && (model->isAnimPlaying("S_BENCH_S1") || model->isAnimPlaying("S_THRONE_S1")))
         d *= -1.0f;
 
     // Set direction
@@ -1434,7 +1361,7 @@ void PlayerController::giveItem(const std::string& instanceName, unsigned int co
     LogInfo() << "Giving " << count << "x " << instanceName << " to " << getScriptInstance().name[0];
 
     // Add our script-instance to the npcs inventory
-    m_World.getScriptEngine().getGameState().createInventoryItem(symIdx, getScriptHandle(), count);
+    getInventory().addItem(symIdx, count);
 }
 
 void PlayerController::exportPart(json& j)
@@ -1707,96 +1634,25 @@ void PlayerController::updateStatusScreen(UI::Menu_Status& statsScreen)
 
 ZenLoad::MaterialGroup PlayerController::getSurfaceMaterial()
 {
-    if (m_MoveState.ground.successful)
-    {
-        return m_World.getWorldMesh().getMaterialGroupOfTriangle(m_MoveState.ground.triangleIndex);
-    }
-    else
-    {
-        return ZenLoad::MaterialGroup::UNDEF;
-    }
-}
+    const Physics::CharacterController::GroundInfo& ground = m_CharacterController.getGround();
 
-void PlayerController::traceDownNPCGround()
-{
-    m_MoveState.ground.successful = false;  // initial condition defaulted to false
-    Math::float3 to = getEntityTransform().Translation();
-    Math::float3 from = to;
-    Math::float3 entityPos = to;
-    to.y = -1000.0f;
-    from.y = 10000.0f;
-    std::vector<Physics::RayTestResult> hitall = m_World.getPhysicsSystem().raytraceAll(from, to, Physics::CollisionShape::CT_WorldMesh);
-    if (hitall.empty())
-    {
-        return;
-    }
-    std::sort(hitall.begin(), hitall.end(), [](const Physics::RayTestResult& a, const Physics::RayTestResult& b) {
-        return a.hitPosition.y > b.hitPosition.y;
-    });
-    if (DEBUG_PLAYER)
+    // Static objects don't know about the material they're made of
+    if (ground.successful && ground.isWorldMesh)
     {
-        LogInfo() << "traceDownNPCGround ITERATION BEGIN";
-    }
-    Physics::RayTestResult result = hitall[0];
-    Physics::RayTestResult resultWater = hitall[0];
-    bool waterMatFound = false;
-    float closestGroundSurfacePos = std::numeric_limits<float>::max();
-    float underWaterGroundPos = std::numeric_limits<float>::min();
-    float waterSurfacePos = 0;
-    for (const auto& a : hitall)
-    {
-        if (!a.hasHit)
-            continue;
-        if ((m_MoveState.ground.successful = m_MoveState.ground.successful || a.hasHit))
-        {
-            auto diff = std::abs(entityPos.y - a.hitPosition.y);
-
-            if (closestGroundSurfacePos > diff)
-            {
-                result = a;
-                closestGroundSurfacePos = diff;
-                underWaterGroundPos = a.hitPosition.y;
-            }
-        }
-    }
-
-    float feet = getModelVisual()->getModelRoot().y;
-
-    // FIXME: Actually read the flying-flag of the MDS
-    if (feet == 0.0f)
-    {
-        feet = 0.9762f;  // FIXME: Boundingbox of the animation or something should be used instead
-    }
-
-    float feetPos = entityPos.y - feet;
-    if (waterMatFound /*&& feetPos < waterSurfacePos*/)
-    {
-        m_MoveState.ground.waterDepth = std::abs(waterSurfacePos - underWaterGroundPos);
-        if (DEBUG_PLAYER)
-        {
-            LogInfo() << "Water depth: " << m_MoveState.ground.waterDepth;
-        }
+        return m_World.getWorldMesh().getMaterialGroupOfTriangle(ground.triangleIndex);
     }
     else
     {
-        m_MoveState.ground.waterDepth = 0.0f;
-    }
-    if (DEBUG_PLAYER)
-    {
-        LogInfo() << "Initial position: " << (getEntityTransform().Translation()).x << " " << (getEntityTransform().Translation()).y << " " << (getEntityTransform().Translation()).z;
-        LogInfo() << "From: " << (from).x << " " << (from).y << " " << (from).z;
-        LogInfo() << "To: " << (to).x << " " << (to).y << " " << (to).z;
-        LogInfo() << "traceDownNPCGround ITERATION END";
+        return ZenLoad::MaterialGroup::UNDEF;
     }
-    m_MoveState.ground.successful = true;
-    m_MoveState.ground.triangleIndex = result.hitTriangleIndex;
-    m_MoveState.ground.trianglePosition = result.hitPosition;
 }
 
 void PlayerController::resetKeyStates()
 {
     m_MoveSpeed1 = false;
     m_MoveSpeed2 = false;
+
+    m_AIHandler.resetKeyStates();
 }
 
 void PlayerController::updatePfxPosition(const pfxEvent& e)
@@ -1885,7 +1741,7 @@ void PlayerController::AniEvent_SFX(const ZenLoad::zCModelScriptEventSfx& sfx)
 
 void PlayerController::AniEvent_SFXGround(const ZenLoad::zCModelScriptEventSfx& sfx)
 {
-    if (m_MoveState.ground.successful)
+    if (m_CharacterController.getGround().successful)
     {
         // Play sound depending on ground type
         ZenLoad::MaterialGroup mat = getSurfaceMaterial();
@@ -1928,6 +1784,10 @@ void PlayerController::AniEvent_PFX(const ZenLoad::zCModelScriptEventPfx& pfx)
     Vob::VobInformation vob = Vob::asVob(m_World, m_activePfxEvents.back().entity);
     Vob::setVisual(vob, pfx.m_Name + ".PFX");
     Vob::setTransform(vob, getEntityTransform());
+
+    // Effects of the player should be the last ones to be thinned out
+    if (vob.visual && isPlayerControlled())
+        ((PfxVisual*)vob.visual)->setPriority(PfxManager::PP_High);
 }
 void PlayerController::AniEvent_PFXStop(const ZenLoad::zCModelScriptEventPfxStop& pfxStop)
 {
@@ -2058,6 +1918,10 @@ void PlayerController::onAction(Engine::ActionType actionType, bool triggered, f
                 // ----- ITEMS -----
                 Handle::EntityHandle nearestItem;
                 float shortestDistItem = 5.0f;
+
+                // Items within reach need to be actual entities to be picked up
+                m_World.getLooseItems().promoteInRadius(getEntityTransform().Translation(), std::sqrt(shortestDistItem));
+
                 const std::set<Handle::EntityHandle>& items = m_World.getScriptEngine().getWorldItems();
                 for (Handle::EntityHandle h : items)
                 {
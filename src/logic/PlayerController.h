@@ -10,17 +10,13 @@
 #include "Pathfinder.h"
 #include "CharacterEquipment.h"
 #include <daedalus/DaedalusGameState.h>
+#include <physics/CharacterController.h>
 
 namespace UI
 {
     class Menu_Status;
 }
 
-namespace Physics
-{
-    struct RayTestResult;
-}
-
 namespace Logic
 {
     class ModelVisual;
@@ -231,18 +227,16 @@ namespace Logic
          */
         NpcAnimationHandler& getNpcAnimationHandler() { return m_NPCAnimationHandler; }
         /**
-         * Places the playercontroller on the ground again. TODO: TESTING-ONLY!
+         * Moves the playercontroller along the ground, sliding along walls and walking up steps.
+         * Only moves freely by the given offset if physics are disabled.
+         * @param motion Offset to move by
          */
-        void placeOnGround();
-        /**
-         * Places the playercontroller on the surface hit by provided rayresult. TODO: TESTING-ONLY!
-         */
-        void placeOnSurface(const Physics::RayTestResult& result);
+        void placeOnGround(const Math::float3& motion = Math::float3(0, 0, 0));
 
         /**
-         * Saves data of the ground on which the NPC is standing
+         * @return Ground on which the NPC is standing, as found by the last move
          */
-        void traceDownNPCGround();
+        const Physics::CharacterController::GroundInfo& getGround() const { return m_CharacterController.getGround(); }
 
         /**
          * @return The script-side handle to this NPC
@@ -429,6 +423,12 @@ namespace Logic
          */
         void setWalkMode(WalkMode walkMode);
 
+        /**
+         * Clears the input gathered from the key-bindings. Those only fire once per rendered frame, so this is
+         * done after the last logic-tick of a frame instead of after each one.
+         */
+        void resetKeyStates();
+
     protected:
         /**
          * Callbacks registered inside the animation-handler
@@ -479,15 +479,6 @@ namespace Logic
             // Where the npc currently is looking at
             Math::float3 direction;
 
-            // Surface data obtained from raytracing the ground below NPC
-            struct
-            {
-                bool successful;  // false if for some reason raytrace failed to hit the ground during last run
-                uint32_t triangleIndex;
-                Math::float3 trianglePosition;
-                float waterDepth;
-            } ground;
-
         } m_MoveState;
 
         struct
@@ -523,6 +514,11 @@ namespace Logic
         Pathfinder m_PathFinder;
         CharacterEquipment m_CharacterEquipment;
 
+        /**
+         * Capsule moving this NPC through the world
+         */
+        Physics::CharacterController m_CharacterController;
+
         /**
          * refuse talk countdown
          */
@@ -567,13 +563,26 @@ namespace Logic
          */
         void updatePfx();
 
-        void resetKeyStates();
-
         // FIXME: Hack for as long as animation-flags are not implemented
         // Turns of modifying the root position from the animation
         bool m_NoAniRootPosHack;
         size_t m_LastAniRootPosUpdatedAniHash;
 
+        /**
+         * Moves the feet by the given offset along the ground and places the NPC there
+         */
+        void placeFeetOnGround(const Math::float3& feet, const Math::float3& motion);
+
+        /**
+         * @return Distance from the feet up to the root of the model
+         */
+        float getFeetHeight();
+
+        /**
+         * Brightness last passed to the visual. -1 if it needs to be set again.
+         */
+        float m_LastShadowValue;
+
         // Main noise sound slot. Other sounds using it won't play if there is already a sound playing here.
         Utils::Ticket<World::AudioWorld> m_MainNoiseSoundSlot;
     };
@@ -0,0 +1,389 @@
+#include "ProjectileManager.h"
+#include <algorithm>
+#include <cmath>
+#include <components/VobClasses.h>
+#include <content/ContentLoad.h>
+#include <content/StaticMeshAllocator.h>
+#include <engine/World.h>
+#include <logic/PlayerController.h>
+#include <logic/ScriptEngine.h>
+#include <logic/messages/EventMessage.h>
+#include <physics/PhysicsSystem.h>
+#include <utils/logger.h>
+
+using namespace Logic;
+
+/**
+ * Upper limit of projectiles in a world. Firing more than that fails.
+ */
+const size_t MAX_NUM_PROJECTILES = 16384;
+
+/**
+ * Gravity pulling down arrows and bolts, in m/s²
+ */
+const float PROJECTILE_GRAVITY = 9.81f;
+
+/**
+ * Seconds after which a projectile which didn't hit anything is removed
+ */
+const float MAX_FLIGHT_TIME = 10.0f;
+
+/**
+ * Seconds a projectile stays stuck in a wall or the ground
+ */
+const float STUCK_TIME = 30.0f;
+
+/**
+ * Size of a cell of the NPC-broadphase in meters. About the distance a fast projectile flies in one frame,
+ * so most segments only touch a few cells.
+ */
+const float NPC_GRID_CELL_SIZE = 4.0f;
+
+/**
+ * NPCs are hit-tested as upright capsule around their center
+ */
+const float NPC_HIT_RADIUS = 0.35f;
+const float NPC_HIT_HALF_HEIGHT = 0.9f - NPC_HIT_RADIUS;
+
+/**
+ * Invalid visual-index, for visuals which failed to load
+ */
+const uint32_t NO_VISUAL = static_cast<uint32_t>(-1);
+
+namespace
+{
+    /**
+     * Closest points between the segments p1-q1 and p2-q2
+     * @param s [out] Position of the closest point along the first segment, 0..1
+     * @return Squared distance between the closest points
+     */
+    float closestPointsOfSegments(const Math::float3& p1, const Math::float3& q1,
+                                  const Math::float3& p2, const Math::float3& q2,
+                                  float& s)
+    {
+        const float epsilon = 1e-6f;
+
+        Math::float3 d1 = q1 - p1;
+        Math::float3 d2 = q2 - p2;
+        Math::float3 r = p1 - p2;
+
+        float a = d1.dot(d1);
+        float e = d2.dot(d2);
+        float f = d2.dot(r);
+        float t;
+
+        if (a <= epsilon)
+        {
+            s = 0.0f;
+            t = e <= epsilon ? 0.0f : Math::clamp(f / e, 0.0f, 1.0f);
+        }
+        else
+        {
+            float c = d1.dot(r);
+
+            if (e <= epsilon)
+            {
+                t = 0.0f;
+                s = Math::clamp(-c / a, 0.0f, 1.0f);
+            }
+            else
+            {
+                float b = d1.dot(d2);
+                float denom = a * e - b * b;
+
+                // Parallel segments can take any point
+                s = denom != 0.0f ? Math::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+                t = (b * s + f) / e;
+
+                if (t < 0.0f)
+                {
+                    t = 0.0f;
+                    s = Math::clamp(-c / a, 0.0f, 1.0f);
+                }
+                else if (t > 1.0f)
+                {
+                    t = 1.0f;
+                    s = Math::clamp((b - c) / a, 0.0f, 1.0f);
+                }
+            }
+        }
+
+        Math::float3 c1 = p1 + d1 * s;
+        Math::float3 c2 = p2 + d2 * t;
+
+        return (c1 - c2).lengthSquared();
+    }
+}
+
+ProjectileManager::ProjectileManager(World::WorldInstance& world, bool deliverDamage)
+    : m_Stats()
+    , m_DeliverDamage(deliverDamage)
+    , m_World(world)
+{
+}
+
+bool ProjectileManager::fire(const std::string& visual,
+                             const Math::float3& position,
+                             const Math::float3& velocity,
+                             Handle::EntityHandle shooter,
+                             bool gravity)
+{
+    if (m_Positions.size() >= MAX_NUM_PROJECTILES)
+        return false;
+
+    uint32_t visualIdx = findVisual(visual);
+    if (visualIdx == NO_VISUAL)
+        return false;
+
+    Math::float3 direction = velocity;
+    if (direction.lengthSquared() < 1e-6f)
+        direction = Math::float3(0, 0, 1);
+
+    m_Positions.push_back(position);
+    m_Velocities.push_back(velocity);
+    m_Directions.push_back(direction.normalize());
+    m_Ages.push_back(0.0f);
+    m_VisualIndices.push_back(visualIdx);
+    m_Shooters.push_back(shooter);
+    m_Flags.push_back(gravity ? F_Gravity : 0);
+
+    return true;
+}
+
+void ProjectileManager::update(double deltaTime)
+{
+    float dt = static_cast<float>(deltaTime);
+
+    m_Stats = Stats();
+
+    if (!m_Positions.empty())
+        buildNpcGrid();
+
+    // Backwards, since removing moves the last projectile into the freed slot
+    for (size_t i = m_Positions.size(); i > 0; i--)
+    {
+        size_t p = i - 1;
+        m_Ages[p] += dt;
+
+        if (m_Flags[p] & F_Stuck)
+        {
+            if (m_Ages[p] > STUCK_TIME)
+                remove(p);
+            else
+                m_Stats.stuck++;
+
+            continue;
+        }
+
+        if (m_Ages[p] > MAX_FLIGHT_TIME)
+        {
+            remove(p);
+            continue;
+        }
+
+        if (m_Flags[p] & F_Gravity)
+            m_Velocities[p].y -= PROJECTILE_GRAVITY * dt;
+
+        Math::float3 from = m_Positions[p];
+        Math::float3 to = from + m_Velocities[p] * dt;
+
+        // Static world first, so NPCs behind walls are not hit
+        m_Stats.worldTests++;
+        Physics::RayTestResult worldHit = m_World.getPhysicsSystem().raytrace(from, to);
+
+        Math::float3 end = worldHit.hasHit ? worldHit.hitPosition : to;
+
+        float fraction;
+        m_Stats.npcTests++;
+        Handle::EntityHandle npc = traceNpcs(from, end, m_Shooters[p], fraction);
+
+        if (npc.isValid())
+        {
+            if (m_DeliverDamage)
+            {
+                VobTypes::NpcVobInformation vob = VobTypes::asNpcVob(m_World, npc);
+
+                EventMessages::DamageMessage msg;
+                msg.subType = static_cast<unsigned int>(EventMessages::DamageMessage::DamageSubType::Once);
+                vob.playerController->getEM().onMessage(msg, m_Shooters[p]);
+            }
+
+            m_Stats.npcHits++;
+            remove(p);
+            continue;
+        }
+
+        if (worldHit.hasHit)
+        {
+            // Stick into whatever was hit
+            m_Positions[p] = worldHit.hitPosition;
+            m_Velocities[p] = Math::float3(0, 0, 0);
+            m_Ages[p] = 0.0f;
+            m_Flags[p] |= F_Stuck;
+            m_Stats.stuck++;
+            continue;
+        }
+
+        m_Positions[p] = to;
+
+        Math::float3 direction = m_Velocities[p];
+        if (direction.lengthSquared() > 1e-6f)
+            m_Directions[p] = direction.normalize();
+
+        m_Stats.flying++;
+    }
+
+    // Gather transforms by visual, so each mesh only has to be set up once for drawing
+    for (ProjectileVisual& v : m_Visuals)
+        v.instances.clear();
+
+    for (size_t i = 0; i < m_Positions.size(); i++)
+    {
+        const Math::float3& d = m_Directions[i];
+        Math::float3 up = std::abs(d.y) > 0.99f ? Math::float3(1, 0, 0) : Math::float3(0, 1, 0);
+
+        m_Visuals[m_VisualIndices[i]].instances.push_back(
+            Math::Matrix::CreateLookAt(m_Positions[i], m_Positions[i] + d, up).Invert());
+    }
+}
+
+void ProjectileManager::clear()
+{
+    m_Positions.clear();
+    m_Velocities.clear();
+    m_Directions.clear();
+    m_Ages.clear();
+    m_VisualIndices.clear();
+    m_Shooters.clear();
+    m_Flags.clear();
+
+    for (ProjectileVisual& v : m_Visuals)
+        v.instances.clear();
+
+    m_Stats = Stats();
+}
+
+void ProjectileManager::remove(size_t idx)
+{
+    size_t last = m_Positions.size() - 1;
+
+    m_Positions[idx] = m_Positions[last];
+    m_Velocities[idx] = m_Velocities[last];
+    m_Directions[idx] = m_Directions[last];
+    m_Ages[idx] = m_Ages[last];
+    m_VisualIndices[idx] = m_VisualIndices[last];
+    m_Shooters[idx] = m_Shooters[last];
+    m_Flags[idx] = m_Flags[last];
+
+    m_Positions.pop_back();
+    m_Velocities.pop_back();
+    m_Directions.pop_back();
+    m_Ages.pop_back();
+    m_VisualIndices.pop_back();
+    m_Shooters.pop_back();
+    m_Flags.pop_back();
+}
+
+void ProjectileManager::buildNpcGrid()
+{
+    for (auto& c : m_NpcGrid)
+        c.second.clear();
+
+    for (Handle::EntityHandle e : m_World.getScriptEngine().getWorldNPCs())
+    {
+        Math::float3 position = m_World.getEntity<Components::PositionComponent>(e).m_WorldMatrix.Translation();
+
+        int x = static_cast<int>(std::floor(position.x / NPC_GRID_CELL_SIZE));
+        int z = static_cast<int>(std::floor(position.z / NPC_GRID_CELL_SIZE));
+
+        m_NpcGrid[makeCellKey(x, z)].push_back({e, position});
+    }
+}
+
+Handle::EntityHandle ProjectileManager::traceNpcs(const Math::float3& from, const Math::float3& to, Handle::EntityHandle shooter, float& fraction)
+{
+    Handle::EntityHandle hit;
+    fraction = 1.0f;
+
+    // NPCs are sorted in by their center, so their capsule may reach into the neighbouring cells
+    float minX = std::min(from.x, to.x) - NPC_HIT_RADIUS;
+    float maxX = std::max(from.x, to.x) + NPC_HIT_RADIUS;
+    float minZ = std::min(from.z, to.z) - NPC_HIT_RADIUS;
+    float maxZ = std::max(from.z, to.z) + NPC_HIT_RADIUS;
+
+    int x0 = static_cast<int>(std::floor(minX / NPC_GRID_CELL_SIZE));
+    int x1 = static_cast<int>(std::floor(maxX / NPC_GRID_CELL_SIZE));
+    int z0 = static_cast<int>(std::floor(minZ / NPC_GRID_CELL_SIZE));
+    int z1 = static_cast<int>(std::floor(maxZ / NPC_GRID_CELL_SIZE));
+
+    for (int x = x0; x <= x1; x++)
+    {
+        for (int z = z0; z <= z1; z++)
+        {
+            auto it = m_NpcGrid.find(makeCellKey(x, z));
+            if (it == m_NpcGrid.end())
+                continue;
+
+            for (const NpcEntry& n : it->second)
+            {
+                if (n.entity == shooter)
+                    continue;
+
+                Math::float3 bottom = n.position - Math::float3(0, NPC_HIT_HALF_HEIGHT, 0);
+                Math::float3 top = n.position + Math::float3(0, NPC_HIT_HALF_HEIGHT, 0);
+
+                float s;
+                if (closestPointsOfSegments(from, to, bottom, top, s) > NPC_HIT_RADIUS * NPC_HIT_RADIUS)
+                    continue;
+
+                if (s < fraction || !hit.isValid())
+                {
+                    hit = n.entity;
+                    fraction = s;
+                }
+            }
+        }
+    }
+
+    return hit;
+}
+
+uint32_t ProjectileManager::findVisual(const std::string& name)
+{
+    std::string visual = name;
+    std::transform(visual.begin(), visual.end(), visual.begin(), ::toupper);
+
+    auto it = m_VisualsByName.find(visual);
+    if (it != m_VisualsByName.end())
+        return it->second;
+
+    uint32_t idx = NO_VISUAL;
+    Handle::MeshHandle mesh = m_World.getStaticMeshAllocator().loadMeshVDF(visual);
+
+    if (mesh.isValid())
+    {
+        Meshes::WorldStaticMesh& mdata = m_World.getStaticMeshAllocator().getMesh(mesh);
+
+        ProjectileVisual v;
+        v.name = visual;
+        v.mesh = mesh;
+
+        for (const std::string& material : mdata.mesh.m_SubmeshMaterialNames)
+            v.textures.push_back(Content::Wrap::loadTextureVDF(m_World, material));
+
+        idx = static_cast<uint32_t>(m_Visuals.size());
+        m_Visuals.push_back(v);
+    }
+    else
+    {
+        LogWarn() << "Failed to load projectile-visual: " << visual;
+    }
+
+    m_VisualsByName[visual] = idx;
+    return idx;
+}
+
+ProjectileManager::CellKey ProjectileManager::makeCellKey(int x, int z) const
+{
+    return (static_cast<CellKey>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+}
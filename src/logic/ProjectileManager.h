@@ -0,0 +1,164 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <handle/HandleDef.h>
+#include <math/mathlib.h>
+
+namespace World
+{
+    class WorldInstance;
+}
+
+namespace Logic
+{
+    /**
+     * Arrows, bolts and spell-projectiles in flight. Projectiles are no entities, but entries in flat arrays
+     * which keep their memory as projectiles come and go.
+     *
+     * Every update moves all projectiles and tests the segment each one covered against the static world
+     * and against the NPCs close to it, so fast projectiles can't tunnel through anything.
+     */
+    class ProjectileManager
+    {
+    public:
+        /**
+         * Mesh shared by all projectiles using the same visual
+         */
+        struct ProjectileVisual
+        {
+            std::string name;
+            Handle::MeshHandle mesh;
+
+            /**
+             * Diffuse texture of each submesh
+             */
+            std::vector<Handle::TextureHandle> textures;
+
+            /**
+             * Transforms of all projectiles using this visual, as of the last update
+             */
+            std::vector<Math::Matrix> instances;
+        };
+
+        /**
+         * Numbers of the last update
+         */
+        struct Stats
+        {
+            size_t flying;
+            size_t stuck;
+            size_t worldTests;
+            size_t npcTests;
+            size_t npcHits;
+        };
+
+        /**
+         * @param deliverDamage Whether NPCs hit are sent a DamageMessage. Off for managers which only measure.
+         */
+        ProjectileManager(World::WorldInstance& world, bool deliverDamage = true);
+
+        /**
+         * Launches a projectile
+         * @param visual Visual to draw the projectile with, ie. "ITRW_ARROW.3DS"
+         * @param position Position to start at
+         * @param velocity Initial velocity in m/s
+         * @param shooter Whoever fired the projectile. Never hit by it.
+         * @param gravity Whether the projectile falls while flying. Spells usually don't.
+         * @return Whether the projectile was created. Fails if the visual can't be loaded or too many are in flight.
+         */
+        bool fire(const std::string& visual,
+                  const Math::float3& position,
+                  const Math::float3& velocity,
+                  Handle::EntityHandle shooter,
+                  bool gravity = true);
+
+        /**
+         * Moves all projectiles, resolves their hits and removes the expired ones
+         * @param deltaTime Time since the last update in seconds
+         */
+        void update(double deltaTime);
+
+        /**
+         * Removes all projectiles
+         */
+        void clear();
+
+        /**
+         * @return Number of projectiles flying or stuck somewhere
+         */
+        size_t getNumProjectiles() const { return m_Positions.size(); }
+
+        const Stats& getStats() const { return m_Stats; }
+
+        /**
+         * @return All visuals with the transforms of the projectiles using them, for rendering
+         */
+        const std::vector<ProjectileVisual>& getVisuals() const { return m_Visuals; }
+
+    private:
+        enum EFlags
+        {
+            F_Gravity = 1 << 0,
+            F_Stuck = 1 << 1
+        };
+
+        struct NpcEntry
+        {
+            Handle::EntityHandle entity;
+            Math::float3 position;
+        };
+
+        typedef uint64_t CellKey;
+
+        /**
+         * Sorts all NPCs of the world into the broadphase-grid
+         */
+        void buildNpcGrid();
+
+        /**
+         * Finds the first NPC touched by the given segment
+         * @param fraction [out] Position of the hit along the segment, 0..1
+         * @return Entity of the NPC, invalid if nobody was hit
+         */
+        Handle::EntityHandle traceNpcs(const Math::float3& from, const Math::float3& to, Handle::EntityHandle shooter, float& fraction);
+
+        /**
+         * Removes the projectile at the given index by moving the last one into its place
+         */
+        void remove(size_t idx);
+
+        /**
+         * @return Index of the visual with the given name, loading it if needed. (uint32_t)-1 if it can't be loaded.
+         */
+        uint32_t findVisual(const std::string& name);
+
+        CellKey makeCellKey(int x, int z) const;
+
+        /**
+         * Projectile-data, one entry per projectile
+         */
+        std::vector<Math::float3> m_Positions;
+        std::vector<Math::float3> m_Velocities;
+        std::vector<Math::float3> m_Directions;
+        std::vector<float> m_Ages;
+        std::vector<uint32_t> m_VisualIndices;
+        std::vector<Handle::EntityHandle> m_Shooters;
+        std::vector<uint8_t> m_Flags;
+
+        std::vector<ProjectileVisual> m_Visuals;
+        std::unordered_map<std::string, uint32_t> m_VisualsByName;
+
+        /**
+         * NPCs by cell on the XZ-plane. Cells are kept around once created, only their contents are cleared.
+         */
+        std::unordered_map<CellKey, std::vector<NpcEntry>> m_NpcGrid;
+
+        Stats m_Stats;
+
+        bool m_DeliverDamage;
+
+        World::WorldInstance& m_World;
+    };
+}
@@ -228,6 +228,31 @@ std::string Engine::SavegameManager::loadSaveGameSlot(int index)
         return "Target world-file invalid: " + buildWorldPath(index, info.world);
     }
     auto timePlayed = info.timePlayed;
+
+    // Save of the world we're currently in (ie. quickload): Keep worldmesh, BSP and collision and only
+    // exchange the dynamic state. This avoids the full level-load.
+    Handle::WorldHandle mainWorld = gameEngine->getMainWorld();
+    if (mainWorld.isValid() && Utils::stripExtension(mainWorld.get().getZenFile()) == info.world)
+    {
+        LogInfo() << "Loading savegame into the already loaded world: " << info.world;
+
+        json worldJson = json::parse(worldFileData);
+        json scriptEngine = json::parse(SavegameManager::readFileInSlot(index, "scriptengine.json"));
+        json dialogManager = json::parse(SavegameManager::readFileInSlot(index, "dialogmanager.json"));
+        json logManager = json::parse(SavegameManager::readFileInSlot(index, "logmanager.json"));
+
+        gameEngine->getSession().resetProgress();
+        gameEngine->getSession().setCurrentSlot(index);
+        gameEngine->getGameClock().setTotalSeconds(timePlayed);
+
+        mainWorld.get().importSavegameState(worldJson, scriptEngine, dialogManager, logManager);
+
+        json playerJson = json::parse(readPlayer(index, "player"));
+        mainWorld.get().importVobAndTakeControl(playerJson);
+
+        return "";
+    }
+
     auto loadSave = [worldFileData, index, timePlayed](BaseEngine* engine) {
         auto resetSession = [](BaseEngine* engine) {
             engine->resetSession();
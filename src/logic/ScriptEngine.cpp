@@ -7,6 +7,7 @@
 #include <engine/GameEngine.h>
 #include <engine/World.h>
 #include <handle/HandleDef.h>
+#include <logic/NpcPool.h>
 #include <logic/scriptExternals/Externals.h>
 #include <logic/scriptExternals/Stubs.h>
 #include <ui/PrintScreenMessages.h>
@@ -84,6 +85,8 @@ int32_t ScriptEngine::runFunction(const std::string& fname, bool clearDataStack)
 
 int32_t ScriptEngine::runFunctionBySymIndex(size_t symIdx, bool clearDataStack)
 {
+    m_World.getEngine()->getMetrics().count(Engine::MetricsServer::C_ScriptCalls);
+
 #if PROFILE_SCRIPT_CALLS
     startProfiling(symIdx);
 #endif
@@ -212,6 +215,21 @@ std::string Logic::ScriptEngine::getSymbolNameByIndex(size_t idx) const
     return m_pVM->getDATFile().getSymbolByIndex(idx).name;
 }
 
+const Daedalus::GEngineClasses::C_Item& ScriptEngine::getItemPrototype(size_t instanceSymbol)
+{
+    auto it = m_ItemPrototypes.find(instanceSymbol);
+    if (it != m_ItemPrototypes.end())
+        return it->second;
+
+    // Let the script-constructor run on a temporary item
+    Daedalus::GameState::ItemHandle h = getGameState().insertItem(instanceSymbol);
+    Daedalus::GEngineClasses::C_Item& prototype = m_ItemPrototypes[instanceSymbol];
+    prototype = getGameState().getItem(h);
+    getGameState().removeItem(h);
+
+    return prototype;
+}
+
 void ScriptEngine::onInventoryItemInserted(Daedalus::GameState::ItemHandle item, Daedalus::GameState::NpcHandle npc)
 {
     Daedalus::GEngineClasses::C_Item& itemData = getGameState().getItem(item);
@@ -245,6 +263,16 @@ void ScriptEngine::onInventoryItemInserted(Daedalus::GameState::ItemHandle item,
 
 void ScriptEngine::onNPCInitialized(Daedalus::GameState::NpcHandle npc)
 {
+    // Scripts which didn't set a body still need a visual and their model loaded
+    VobTypes::NpcVobInformation vob = VobTypes::getVobFromScriptHandle(m_World, npc);
+    if (vob.isValid())
+    {
+        VobTypes::NPC_EndSetup(vob, "");
+
+        // Items created by the script-constructor are all still exactly like their prototype
+        vob.playerController->getInventory().shareCreatedItems();
+    }
+
     // Initialize daily routine
     Daedalus::GEngineClasses::C_Npc& npcData = getGameState().getNpc(npc);
 
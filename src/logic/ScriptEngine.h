@@ -154,6 +154,13 @@ namespace Logic
         Daedalus::GameState::ItemHandle getItemFromSymbol(const std::string& symName);
         Daedalus::GameState::MusicThemeHandle getMusicThemeFromSymbol(const std::string& symName);
 
+        /**
+         * @param instanceSymbol Script instance of an item
+         * @return Item-data as left by the script-constructor of the instance. Created once per instance and shared,
+         *         so this must not be modified.
+         */
+        const Daedalus::GEngineClasses::C_Item& getItemPrototype(size_t instanceSymbol);
+
         /**
          * (Un)Registers an item-instance currently sitting inside the world
          * @param e Entity of the item-instance
@@ -247,6 +254,11 @@ namespace Logic
         std::set<Handle::EntityHandle> m_WorldItems;
         std::set<Handle::EntityHandle> m_WorldMobs;
 
+        /**
+         * Item-data by instance symbol, see getItemPrototype()
+         */
+        std::map<size_t, Daedalus::GEngineClasses::C_Item> m_ItemPrototypes;
+
         /**
          * NPC-Entity of the player
          */
@@ -156,6 +156,12 @@ void EventManager::clear()
     }
 }
 
+void EventManager::setHostVob(Handle::EntityHandle hostVob)
+{
+    clear();
+    m_HostVob = hostVob;
+}
+
 bool EventManager::isEmpty()
 {
     for (SharedEMessage ev : m_EventQueue)
@@ -66,6 +66,11 @@ namespace Logic
          */
         void clear();
 
+        /**
+         * Moves this event manager over to another vob. Pending messages are dropped.
+         */
+        void setHostVob(Handle::EntityHandle hostVob);
+
         /**
          * Exports this as JSON-String
          * @return
@@ -8,6 +8,7 @@
 #include <daedalus/DaedalusVM.h>
 #include <debugdraw/debugdraw.h>
 #include <engine/GameEngine.h>
+#include <engine/LooseItems.h>
 #include <logic/PlayerController.h>
 #include <logic/visuals/ModelVisual.h>
 #include <ui/Hud.h>
@@ -170,7 +171,10 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         if (armorInstance != -1)
         {
             // TODO: Right now, this equips the item automatically. When this is done properly, call the equip-method here
-            vm.getGameState().createInventoryItem(static_cast<size_t>(armorInstance), hnpc);
+            if (npcData.userPtr)
+                getNPCByInstance(self).playerController->getInventory().addItem(static_cast<size_t>(armorInstance));
+            else
+                vm.getGameState().createInventoryItem(static_cast<size_t>(armorInstance), hnpc);
         }
     });
 
@@ -213,8 +217,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 
         if (npc.isValid())
         {
-            Daedalus::GameState::ItemHandle item = vm.getGameState().createInventoryItem(instance,
-                                                                                         VobTypes::getScriptHandle(npc));
+            Daedalus::GameState::ItemHandle item = npc.playerController->getInventory().addItem(instance);
             VobTypes::NPC_EquipWeapon(npc, item);
         }
         else
@@ -937,7 +940,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 
         VobTypes::NpcVobInformation npc = getNPCByInstance(self);
 
-        if (npc.isValid())
+        if (npc.isValid() && npc.playerController->getModelVisual())
         {
             npc.playerController->getModelVisual()->applyOverlay(overlayname);
         }
@@ -949,7 +952,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 
         VobTypes::NpcVobInformation npc = getNPCByInstance(self);
 
-        if (npc.isValid())
+        if (npc.isValid() && npc.playerController->getModelVisual())
         {
             // TODO: Implement using of multiple overlays!
             npc.playerController->getModelVisual()->applyOverlay("");
@@ -1110,19 +1113,13 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
             return;
         }
 
-        vm.getGameState().insertNPC(npcinstance, spawnpoint);
+        VobTypes::Wld_InsertNpc(*pWorld, npcinstance, spawnpoint);
     });
 
     vm->registerExternalFunction("wld_insertitem", [=](Daedalus::DaedalusVM& vm) {
         std::string spawnpoint = vm.popString(true);
         uint32_t iteminstance = vm.popDataValue();
 
-        // Create object
-        Handle::EntityHandle e = VobTypes::initItemFromScript(*pWorld, iteminstance);
-
-        // Position the vob
-        Vob::VobInformation vob = Vob::asVob(*pWorld, e);
-
         // Try vobs first
         Handle::EntityHandle spawnEnt = pWorld->getVobEntityByName(spawnpoint);
 
@@ -1147,7 +1144,15 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
             position = pWorld->getWaynet().waypoints[wp].position;
         }
 
+        // Nobody holds on to the inserted item, so it can start out as loose item
+        if (pWorld->getLooseItems().addItem(iteminstance, Math::Matrix::CreateTranslation(position)))
+            return;
+
+        // Create object
+        Handle::EntityHandle e = VobTypes::initItemFromScript(*pWorld, iteminstance);
+
         // Move item to right place
+        Vob::VobInformation vob = Vob::asVob(*pWorld, e);
         Vob::setPosition(vob, position);
     });
 
@@ -1353,7 +1358,11 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 
         NpcHandle hnpc = ZMemory::handleCast<NpcHandle>(vm.getDATFile().getSymbolByIndex(npc).instanceDataHandle);
 
-        vm.getGameState().createInventoryItem(itemInstance, hnpc);
+        // NPCs still running their script-constructor don't have a vob yet. Their items are shared once inserted.
+        if (hnpc.isValid() && vm.getGameState().getNpc(hnpc).userPtr)
+            getNPCByInstance(npc).playerController->getInventory().addSharedItem(itemInstance);
+        else
+            vm.getGameState().createInventoryItem(itemInstance, hnpc);
 
         /*
         Daedalus::GEngineClasses::C_Npc& npcData = vm.getGameState().getNpc(hnpc);
@@ -1373,7 +1382,11 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 
         NpcHandle hnpc = ZMemory::handleCast<NpcHandle>(vm.getDATFile().getSymbolByIndex(npc).instanceDataHandle);
 
-        vm.getGameState().createInventoryItem(itemInstance, hnpc, num);
+        // NPCs still running their script-constructor don't have a vob yet. Their items are shared once inserted.
+        if (hnpc.isValid() && vm.getGameState().getNpc(hnpc).userPtr)
+            getNPCByInstance(npc).playerController->getInventory().addSharedItem(itemInstance, num);
+        else
+            vm.getGameState().createInventoryItem(itemInstance, hnpc, num);
     });
 
     vm->registerExternalFunction("hlp_getnpc", [=](Daedalus::DaedalusVM& vm) {
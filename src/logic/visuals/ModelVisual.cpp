@@ -320,11 +320,12 @@ void ModelVisual::setHeadMesh(const std::string& head, int headTextureIdx, int t
         v += ".MMB";
     }
 
-    m_BodyState.headVisual = v;
-    m_BodyState.headTextureIdx = headTextureIdx;
-    m_BodyState.teethTextureIdx = teethTextureIdx;
+    BodyState state = m_BodyState;
+    state.headVisual = v;
+    state.headTextureIdx = headTextureIdx;
+    state.teethTextureIdx = teethTextureIdx;
 
-    setBodyState(m_BodyState);
+    setBodyState(state);
 }
 
 void ModelVisual::rebuildMainEntityList()
@@ -502,6 +503,34 @@ Handle::EntityHandle ModelVisual::setNodeVisual(const std::string& visual, const
     }
 }
 
+void ModelVisual::clearAttachments()
+{
+    std::vector<std::string> nodes;
+    for (const auto& p : m_AttachmentVisualsByNode)
+    {
+        if (p.first != MODEL_NODE_NAME_HEAD)
+            nodes.push_back(p.first);
+    }
+
+    for (const std::string& node : nodes)
+    {
+        setNodeVisual("", node);
+        m_AttachmentVisualsByNode.erase(node);
+    }
+}
+
+void ModelVisual::setHostEntity(Handle::EntityHandle entity)
+{
+    m_Entity = entity;
+    m_EventManager.setHostVob(entity);
+
+    for (Handle::EntityHandle e : m_PartEntities.mainSkelMeshEntities)
+        m_World.getEntity<Components::AnimationComponent>(e).m_ParentAnimHandler = entity;
+
+    // Move everything from where the old host was parked
+    onTransformChanged();
+}
+
 size_t ModelVisual::findNodeIndex(const std::string& name)
 {
     return getMeshLib().findNodeIndex(name);
@@ -598,6 +627,10 @@ void ModelVisual::onFrameUpdate(float dt)
 
 void ModelVisual::setBodyState(const ModelVisual::BodyState& state)
 {
+    // Already set up like this, ie. when reused from the NPC-pool
+    if (state == m_BodyState && !m_PartEntities.mainSkelMeshEntities.empty())
+        return;
+
     m_BodyState = state;
 
     updateBodyMesh();
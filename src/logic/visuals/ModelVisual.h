@@ -129,6 +129,11 @@ namespace Logic
                 bodyTextureIdx = 0;
             }
 
+            bool operator==(const BodyState& other) const
+            {
+                return headVisual == other.headVisual && bodyVisual == other.bodyVisual && headTextureIdx == other.headTextureIdx && teethTextureIdx == other.teethTextureIdx && bodySkinColorIdx == other.bodySkinColorIdx && bodyTextureIdx == other.bodyTextureIdx;
+            }
+
             std::string headVisual;
             std::string bodyVisual;
             int headTextureIdx;
@@ -171,6 +176,17 @@ namespace Logic
         Handle::EntityHandle setNodeVisual(const std::string& visual, const std::string& nodeName);
         Handle::EntityHandle setNodeVisual(const std::string& visual, EModelNode node);
 
+        /**
+         * Removes all visuals attached to nodes, except for the head
+         */
+        void clearAttachments();
+
+        /**
+         * Moves this visual over to the given entity, which must already have the animation-handler of this one.
+         * Used when a pooled NPC-shell is reused.
+         */
+        void setHostEntity(Handle::EntityHandle entity);
+
         /**
          * @brief Sets the currently playing animation. Empty string for none
          */
@@ -4,6 +4,7 @@
 
 #include "PfxVisual.h"
 #include <stdlib.h>
+#include <algorithm>
 #include <ZenLib/utils/logger.h>
 #include <bx/math.h>
 #include <components/EntityActions.h>
@@ -19,9 +20,14 @@ Logic::PfxVisual::PfxVisual(World::WorldInstance& world, Handle::EntityHandle en
     , m_shpScaleKey(0.0f)
     , m_spawnPosition(0.0f)
     , m_dead(false)
+    , m_SkippedTime(0.0f)
+    , m_Priority(PfxManager::PP_Normal)
 {
     Components::Actions::initComponent<Components::PfxComponent>(m_World.getComponentAllocator(), entity);
     Components::Actions::initComponent<Components::BBoxComponent>(m_World.getComponentAllocator(), entity);
+
+    // Count as visible until the renderer had a chance to tell otherwise
+    getPfxComponent().m_LastDrawnFrame = m_World.getPfxManager().getFrame();
 }
 
 Logic::PfxVisual::~PfxVisual()
@@ -46,6 +52,9 @@ bool Logic::PfxVisual::load(const std::string& visual)
 
     m_Emitter = m_World.getPfxManager().getParticleFX(sym);
 
+    if (m_Emitter.isAmbientPFX)
+        m_Priority = PfxManager::PP_Low;
+
     // Need that one. Or should give a default value of 1?
     //assert(!m_Emitter.ppsScaleKeys.empty());
     if (m_Emitter.ppsScaleKeys.empty())
@@ -105,52 +114,49 @@ void Logic::PfxVisual::onUpdate(float deltaTime)
     Components::PfxComponent& pfx = getPfxComponent();
     Controller::onUpdate(deltaTime);
 
-    // Spawn new particles. Need to accumulate deltaTime so the floor doesn't keep us from spawning any particles
-    // on high fps-rates
-    m_TimeSinceLastSpawn += deltaTime;
+    // The renderer stamps the component every time it gets drawn. All ticks of a frame look at the frame before.
+    bool visible = pfx.m_LastDrawnFrame + 1 >= m_World.getPfxManager().getFrame();
 
-    // Update rates
-    m_ppsScaleKey += deltaTime * m_Emitter.ppsFPS;
-    m_shpScaleKey += deltaTime * m_Emitter.shpScaleFPS;
+    advanceScaleKeys(deltaTime);
 
-    // Loop ppsScaleKeys if wanted
-    if (Math::ifloor(m_ppsScaleKey) >= static_cast<int>(m_Emitter.ppsScaleKeys.size()))
-    {  //&& !m_Emitter.ppsIsLooping) {
-        m_ppsScaleKey = 0.0f;
-        if (!m_Emitter.ppsIsLooping)
-        {
-            m_dead = true;
-        }
-    }
-    if (Math::ifloor(m_shpScaleKey) >= static_cast<int>(m_Emitter.shpScaleKeys.size()))
-    {  //&& !m_Emitter.shpScaleIsLooping){
-        m_shpScaleKey = 0.0f;
-        if (!m_Emitter.shpScaleIsLooping)
+    if (!visible)
+    {
+        // Nobody is looking. Only keep track of the time, so the system can catch up once it's back in view.
+        m_SkippedTime += deltaTime;
+
+        // One-shot effects still need to finish, so they get removed
+        if (m_dead && (pfx.m_Particles.empty() || m_SkippedTime > m_Emitter.lspPartAvg + m_Emitter.lspPartVar))
         {
-            m_dead = true;
+            pfx.m_Particles.clear();
+            m_canBeRemoved = true;
         }
+
+        m_World.getPfxManager().reportParticles(0, pfx.m_Particles.size());
+        return;
     }
-    //FIXME There is still a case when no scale keys are given and ppsIsLooping is false. See world of gothic
 
-    // Perform spawning rate modulation
-    float ppsKeyFrac = fmod(m_ppsScaleKey, 1.0f);  // For interpolation
-    float ppsMod1 = m_Emitter.ppsScaleKeys[Math::ifloor(m_ppsScaleKey)];
-    float ppsMod2 = m_Emitter.ppsScaleKeys[(Math::ifloor(m_ppsScaleKey) + 1) % m_Emitter.ppsScaleKeys.size()];
-    float ppsModTotal = m_Emitter.ppsIsSmooth ? bx::flerp(ppsMod1, ppsMod2, ppsKeyFrac) : ppsMod1;
+    // Reset BBox, so we can fit it around the current state of the system
+    m_BBox.min = {FLT_MAX, FLT_MAX, FLT_MAX};
+    m_BBox.max = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+    if (m_SkippedTime > 0.0f)
+        catchUp();
 
-    int toSpawn = Math::ifloor(m_Emitter.ppsValue * m_TimeSinceLastSpawn * ppsModTotal);
+    // Spawn new particles. Need to accumulate deltaTime so the floor doesn't keep us from spawning any particles
+    // on high fps-rates
+    m_TimeSinceLastSpawn += deltaTime;
+
+    int toSpawn = Math::ifloor(m_Emitter.ppsValue * m_TimeSinceLastSpawn * getSpawnRateModifier());
     if (toSpawn > 1 && !m_dead)
     {
-        for (int i = 0; i < toSpawn; i++)
+        size_t granted = m_World.getPfxManager().requestParticles(static_cast<size_t>(toSpawn), m_Priority);
+
+        for (size_t i = 0; i < granted; i++)
             spawnParticle();
 
         m_TimeSinceLastSpawn = 0.0f;
     }
 
-    // Reset BBox, so we can fit it around the current state of the system
-    m_BBox.min = {FLT_MAX, FLT_MAX, FLT_MAX};
-    m_BBox.max = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
-
     // Update particle values
     for (Components::PfxComponent::Particle& p : pfx.m_Particles)
         updateParticle(p, deltaTime);
@@ -176,6 +182,9 @@ void Logic::PfxVisual::onUpdate(float deltaTime)
     {
         m_canBeRemoved = true;
     }
+
+    m_World.getPfxManager().reportParticles(pfx.m_Particles.size(), 0);
+
     m_BBox.min -= getEntityTransform().Translation();
     m_BBox.max -= getEntityTransform().Translation();
 
@@ -185,6 +194,76 @@ void Logic::PfxVisual::onUpdate(float deltaTime)
     bbox.m_SphereRadius = (m_BBox.min * 0.5f + m_BBox.max * 0.5f).length() + fabs((m_BBox.max - m_BBox.min).length()) * 0.5f;
 }
 
+void Logic::PfxVisual::advanceScaleKeys(float deltaTime)
+{
+    // Update rates
+    m_ppsScaleKey += deltaTime * m_Emitter.ppsFPS;
+    m_shpScaleKey += deltaTime * m_Emitter.shpScaleFPS;
+
+    // Loop ppsScaleKeys if wanted
+    if (Math::ifloor(m_ppsScaleKey) >= static_cast<int>(m_Emitter.ppsScaleKeys.size()))
+    {  //&& !m_Emitter.ppsIsLooping) {
+        m_ppsScaleKey = 0.0f;
+        if (!m_Emitter.ppsIsLooping)
+        {
+            m_dead = true;
+        }
+    }
+    if (Math::ifloor(m_shpScaleKey) >= static_cast<int>(m_Emitter.shpScaleKeys.size()))
+    {  //&& !m_Emitter.shpScaleIsLooping){
+        m_shpScaleKey = 0.0f;
+        if (!m_Emitter.shpScaleIsLooping)
+        {
+            m_dead = true;
+        }
+    }
+    //FIXME There is still a case when no scale keys are given and ppsIsLooping is false. See world of gothic
+}
+
+float Logic::PfxVisual::getSpawnRateModifier()
+{
+    // Perform spawning rate modulation
+    float ppsKeyFrac = fmod(m_ppsScaleKey, 1.0f);  // For interpolation
+    float ppsMod1 = m_Emitter.ppsScaleKeys[Math::ifloor(m_ppsScaleKey)];
+    float ppsMod2 = m_Emitter.ppsScaleKeys[(Math::ifloor(m_ppsScaleKey) + 1) % m_Emitter.ppsScaleKeys.size()];
+    float ppsModTotal = m_Emitter.ppsIsSmooth ? bx::flerp(ppsMod1, ppsMod2, ppsKeyFrac) : ppsMod1;
+
+    // Thin out particles when the engine is short on frametime
+    float density = m_World.getEngine()->getQualityGovernor().getParticleDensity();
+
+    return ppsModTotal * density;
+}
+
+void Logic::PfxVisual::catchUp()
+{
+    Components::PfxComponent& pfx = getPfxComponent();
+
+    float skipped = m_SkippedTime;
+    m_SkippedTime = 0.0f;
+    m_TimeSinceLastSpawn = 0.0f;
+
+    // Move the particles which were there before in one big step. Most of them will have died by now.
+    for (Components::PfxComponent::Particle& p : pfx.m_Particles)
+        updateParticle(p, skipped);
+
+    if (m_dead)
+        return;
+
+    // Add the particles which would have been spawned in the meantime and are still alive, with random age
+    float window = std::min(skipped, m_Emitter.lspPartAvg + m_Emitter.lspPartVar);
+    int wanted = Math::ifloor(m_Emitter.ppsValue * window * getSpawnRateModifier());
+
+    if (wanted <= 0)
+        return;
+
+    size_t granted = m_World.getPfxManager().requestParticles(static_cast<size_t>(wanted), m_Priority);
+    for (size_t i = 0; i < granted; i++)
+    {
+        spawnParticle();
+        updateParticle(pfx.m_Particles.back(), Utils::frand() * window);
+    }
+}
+
 void Logic::PfxVisual::spawnParticle()
 {
     Components::PfxComponent& pfx = getPfxComponent();
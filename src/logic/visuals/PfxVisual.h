@@ -46,6 +46,11 @@ namespace Logic
         */
         bool isDead(){return m_dead;};
 
+        /**
+         * Sets how important this effect is when the particle-budget runs short
+         */
+        void setPriority(PfxManager::EPriority priority) { m_Priority = priority; }
+
     private:
         /**
          * Spawns a single particle after the rules of the emitter
@@ -57,6 +62,21 @@ namespace Logic
          */
         void updateParticle(Components::PfxComponent::Particle& p, float deltaTime);
 
+        /**
+         * Moves the pps- and shp-scale keys forward. Marks the emitter as dead, once non-looping keys run out.
+         */
+        void advanceScaleKeys(float deltaTime);
+
+        /**
+         * @return Current modulation of the spawnrate
+         */
+        float getSpawnRateModifier();
+
+        /**
+         * Brings the system into the state it would have had, if it had been simulated during m_SkippedTime
+         */
+        void catchUp();
+
         /**
          * Updates the bbox around the whole system to contain the given particle
          */
@@ -98,6 +118,16 @@ namespace Logic
          */
         bool m_canBeRemoved =false;
 
+        /**
+         * Time this system was out of view and not simulated
+         */
+        float m_SkippedTime;
+
+        /**
+         * Importance of this effect for the particle-budget
+         */
+        PfxManager::EPriority m_Priority;
+
 
 
         /**
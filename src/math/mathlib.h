@@ -7,6 +7,7 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/norm.hpp>
 #include <ZenLib/utils/mathlib.h>
+#include "simd.h"
 
 namespace Math
 {
@@ -522,7 +523,7 @@ namespace Math
         }
         Matrix& operator*=(const Matrix& M)
         {
-            _glmMatrix *= M._glmMatrix;
+            Simd::mul4x4(mv, M.mv, mv);
             return *this;
         }
         Matrix& operator*=(float s)
@@ -602,7 +603,14 @@ namespace Math
         }
 
         Matrix Transpose() const { return glm::transpose(_glmMatrix); }
-        Matrix Invert() const { return glm::inverse(_glmMatrix); }
+        Matrix Invert() const
+        {
+            Matrix r;
+            if (!Simd::invert4x4(mv, r.mv))
+                return glm::inverse(_glmMatrix);
+
+            return r;
+        }
         Math::float3 Rotate(const Math::float3& v) const
         {
             Math::float3 tmp = (*this) * v;
@@ -758,7 +766,7 @@ namespace Math
     inline float4 operator*(const Matrix& m, const float4& v)
     {
         float4 r;
-        r._glmt_vector = m._glmMatrix * v._glmt_vector;
+        Simd::store(r.v, Simd::transform4(m.mv, Simd::load(v.v)));
         return r;
     }
 
@@ -767,16 +775,18 @@ namespace Math
      */
     inline float3 operator*(const Matrix& m, const float3& v)
     {
-        float4 r;
-        r._glmt_vector = m._glmMatrix * float4(v.x, v.y, v.z, 1.0f)._glmt_vector;
-        return float3(r.x, r.y, r.z);
+        float r[4];
+        Simd::store(r, Simd::transform4(m.mv, Simd::set(v.x, v.y, v.z, 1.0f)));
+        return float3(r[0], r[1], r[2]);
     }
 
     std::ostream& operator<<(std::ostream& out, Matrix& m);
 
     inline Matrix operator*(const Matrix& M1, const Matrix& M2)
     {
-        return M1._glmMatrix * M2._glmMatrix;
+        Matrix r;
+        Simd::mul4x4(M1.mv, M2.mv, r.mv);
+        return r;
     }
 
     /** 
@@ -0,0 +1,238 @@
+#pragma once
+
+/**
+ * Minimal 4-wide float vector used to speed up the hot matrix-operations of mathlib.h.
+ * Uses SSE2 or NEON where available and falls back to plain scalar code otherwise.
+ *
+ * All loads and stores are unaligned: Math::Matrix and friends are stored inside std::vectors,
+ * components and vertex-buffers, none of which guarantee 16-byte alignment.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RE_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define RE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Math
+{
+    namespace Simd
+    {
+#if defined(RE_SIMD_SSE2)
+        typedef __m128 vec4;
+
+        inline vec4 load(const float* p) { return _mm_loadu_ps(p); }
+        inline void store(float* p, vec4 v) { _mm_storeu_ps(p, v); }
+        inline vec4 splat(float f) { return _mm_set1_ps(f); }
+        inline vec4 set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+        inline vec4 add(vec4 a, vec4 b) { return _mm_add_ps(a, b); }
+        inline vec4 sub(vec4 a, vec4 b) { return _mm_sub_ps(a, b); }
+        inline vec4 mul(vec4 a, vec4 b) { return _mm_mul_ps(a, b); }
+
+        /**
+         * @return a * b + c
+         */
+        inline vec4 madd(vec4 a, vec4 b, vec4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+        /**
+         * @return Vector with all lanes set to the given lane of v
+         */
+        template <int lane>
+        inline vec4 splatLane(vec4 v)
+        {
+            return _mm_shuffle_ps(v, v, _MM_SHUFFLE(lane, lane, lane, lane));
+        }
+#elif defined(RE_SIMD_NEON)
+        typedef float32x4_t vec4;
+
+        inline vec4 load(const float* p) { return vld1q_f32(p); }
+        inline void store(float* p, vec4 v) { vst1q_f32(p, v); }
+        inline vec4 splat(float f) { return vdupq_n_f32(f); }
+        inline vec4 set(float x, float y, float z, float w)
+        {
+            const float f[4] = {x, y, z, w};
+            return vld1q_f32(f);
+        }
+        inline vec4 add(vec4 a, vec4 b) { return vaddq_f32(a, b); }
+        inline vec4 sub(vec4 a, vec4 b) { return vsubq_f32(a, b); }
+        inline vec4 mul(vec4 a, vec4 b) { return vmulq_f32(a, b); }
+        inline vec4 madd(vec4 a, vec4 b, vec4 c) { return vmlaq_f32(c, a, b); }
+
+        template <int lane>
+        inline vec4 splatLane(vec4 v)
+        {
+            return vdupq_n_f32(vgetq_lane_f32(v, lane));
+        }
+#else
+        struct vec4
+        {
+            float f[4];
+        };
+
+        inline vec4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+        inline void store(float* p, vec4 v)
+        {
+            for (int i = 0; i < 4; i++)
+                p[i] = v.f[i];
+        }
+        inline vec4 splat(float f) { return {{f, f, f, f}}; }
+        inline vec4 set(float x, float y, float z, float w) { return {{x, y, z, w}}; }
+        inline vec4 add(vec4 a, vec4 b) { return {{a.f[0] + b.f[0], a.f[1] + b.f[1], a.f[2] + b.f[2], a.f[3] + b.f[3]}}; }
+        inline vec4 sub(vec4 a, vec4 b) { return {{a.f[0] - b.f[0], a.f[1] - b.f[1], a.f[2] - b.f[2], a.f[3] - b.f[3]}}; }
+        inline vec4 mul(vec4 a, vec4 b) { return {{a.f[0] * b.f[0], a.f[1] * b.f[1], a.f[2] * b.f[2], a.f[3] * b.f[3]}}; }
+        inline vec4 madd(vec4 a, vec4 b, vec4 c) { return add(mul(a, b), c); }
+
+        template <int lane>
+        inline vec4 splatLane(vec4 v)
+        {
+            return splat(v.f[lane]);
+        }
+#endif
+
+        /**
+         * Multiplies two column-major 4x4 matrices: out = a * b. out may alias a or b.
+         */
+        inline void mul4x4(const float* a, const float* b, float* out)
+        {
+            vec4 a0 = load(a + 0);
+            vec4 a1 = load(a + 4);
+            vec4 a2 = load(a + 8);
+            vec4 a3 = load(a + 12);
+
+            vec4 r[4];
+            for (int c = 0; c < 4; c++)
+            {
+                vec4 bc = load(b + c * 4);
+
+                vec4 v = mul(a0, splatLane<0>(bc));
+                v = madd(a1, splatLane<1>(bc), v);
+                v = madd(a2, splatLane<2>(bc), v);
+                v = madd(a3, splatLane<3>(bc), v);
+                r[c] = v;
+            }
+
+            for (int c = 0; c < 4; c++)
+                store(out + c * 4, r[c]);
+        }
+
+        /**
+         * Transforms the given vector by a column-major 4x4 matrix
+         */
+        inline vec4 transform4(const float* m, vec4 v)
+        {
+            vec4 r = mul(load(m + 0), splatLane<0>(v));
+            r = madd(load(m + 4), splatLane<1>(v), r);
+            r = madd(load(m + 8), splatLane<2>(v), r);
+            r = madd(load(m + 12), splatLane<3>(v), r);
+            return r;
+        }
+
+        /**
+         * Computes the dot-product of (x, y, z, 1) with each of the given planes (nx, ny, nz, d)
+         * and classifies the sphere at that position against all of them.
+         * @return -1 if the sphere is completely behind one of the planes, 0 if it intersects any of them, 1 otherwise
+         */
+        inline int classifySphere(const float* planes, int numPlanes, float x, float y, float z, float radius)
+        {
+            vec4 p = set(x, y, z, 1.0f);
+            int result = 1;
+
+            for (int i = 0; i < numPlanes; i++)
+            {
+                float d[4];
+                store(d, mul(load(planes + i * 4), p));
+
+                float dist = (d[0] + d[1]) + (d[2] + d[3]);
+                if (dist < -radius)
+                    return -1;
+
+                if (dist < radius)
+                    result = 0;
+            }
+
+            return result;
+        }
+
+        /**
+         * Inverts a 4x4 matrix using 2x2 sub-blocks. Only available with SSE2.
+         * @return false if not implemented for this platform. out is untouched then.
+         */
+        inline bool invert4x4(const float* in, float* out)
+        {
+#if defined(RE_SIMD_SSE2)
+#define RE_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define RE_SWIZZLE(a, x, y, z, w) RE_SHUFFLE(a, a, x, y, z, w)
+            // 2x2 matrices are stored as (m00, m01, m10, m11)
+            // A * B
+            auto mat2Mul = [](__m128 a, __m128 b) {
+                return _mm_add_ps(_mm_mul_ps(a, RE_SWIZZLE(b, 0, 3, 0, 3)),
+                                  _mm_mul_ps(RE_SWIZZLE(a, 1, 0, 3, 2), RE_SWIZZLE(b, 2, 1, 2, 1)));
+            };
+            // adj(A) * B
+            auto mat2AdjMul = [](__m128 a, __m128 b) {
+                return _mm_sub_ps(_mm_mul_ps(RE_SWIZZLE(a, 3, 3, 0, 0), b),
+                                  _mm_mul_ps(RE_SWIZZLE(a, 1, 1, 2, 2), RE_SWIZZLE(b, 2, 3, 0, 1)));
+            };
+            // A * adj(B)
+            auto mat2MulAdj = [](__m128 a, __m128 b) {
+                return _mm_sub_ps(_mm_mul_ps(a, RE_SWIZZLE(b, 3, 0, 3, 0)),
+                                  _mm_mul_ps(RE_SWIZZLE(a, 1, 0, 3, 2), RE_SWIZZLE(b, 2, 1, 2, 1)));
+            };
+
+            __m128 r0 = _mm_loadu_ps(in + 0);
+            __m128 r1 = _mm_loadu_ps(in + 4);
+            __m128 r2 = _mm_loadu_ps(in + 8);
+            __m128 r3 = _mm_loadu_ps(in + 12);
+
+            // Sub-blocks. Since inverse(transpose(M)) == transpose(inverse(M)), the same code
+            // works for row- and column-major storage.
+            __m128 A = _mm_movelh_ps(r0, r1);
+            __m128 B = _mm_movehl_ps(r1, r0);
+            __m128 C = _mm_movelh_ps(r2, r3);
+            __m128 D = _mm_movehl_ps(r3, r2);
+
+            // Determinants of all sub-blocks: (|A|, |B|, |C|, |D|)
+            __m128 detSub = _mm_sub_ps(_mm_mul_ps(RE_SHUFFLE(r0, r2, 0, 2, 0, 2), RE_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+                                       _mm_mul_ps(RE_SHUFFLE(r0, r2, 1, 3, 1, 3), RE_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+            __m128 detA = RE_SWIZZLE(detSub, 0, 0, 0, 0);
+            __m128 detB = RE_SWIZZLE(detSub, 1, 1, 1, 1);
+            __m128 detC = RE_SWIZZLE(detSub, 2, 2, 2, 2);
+            __m128 detD = RE_SWIZZLE(detSub, 3, 3, 3, 3);
+
+            __m128 D_C = mat2AdjMul(D, C);
+            __m128 A_B = mat2AdjMul(A, B);
+
+            __m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), mat2Mul(B, D_C));
+            __m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), mat2Mul(C, A_B));
+            __m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), mat2MulAdj(D, A_B));
+            __m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), mat2MulAdj(A, D_C));
+
+            // |M| = |A|*|D| + |B|*|C| - tr(adj(A)B * adj(D)C)
+            __m128 detM = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+            __m128 tr = _mm_mul_ps(A_B, RE_SWIZZLE(D_C, 0, 2, 1, 3));
+            tr = _mm_add_ps(tr, RE_SWIZZLE(tr, 2, 3, 0, 1));
+            tr = _mm_add_ps(tr, RE_SWIZZLE(tr, 1, 0, 3, 2));
+            detM = _mm_sub_ps(detM, tr);
+
+            __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+
+            X_ = _mm_mul_ps(X_, rDetM);
+            Y_ = _mm_mul_ps(Y_, rDetM);
+            Z_ = _mm_mul_ps(Z_, rDetM);
+            W_ = _mm_mul_ps(W_, rDetM);
+
+            _mm_storeu_ps(out + 0, RE_SHUFFLE(X_, Y_, 3, 1, 3, 1));
+            _mm_storeu_ps(out + 4, RE_SHUFFLE(X_, Y_, 2, 0, 2, 0));
+            _mm_storeu_ps(out + 8, RE_SHUFFLE(Z_, W_, 3, 1, 3, 1));
+            _mm_storeu_ps(out + 12, RE_SHUFFLE(Z_, W_, 2, 0, 2, 0));
+#undef RE_SWIZZLE
+#undef RE_SHUFFLE
+            return true;
+#else
+            return false;
+#endif
+        }
+    }
+}
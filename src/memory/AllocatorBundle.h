@@ -85,6 +85,18 @@ namespace Memory
             m_NumObtainedObjects--;
         }
 
+        /**
+         * Marks all elements as free. Calls the "OnRemoved"-Callbacks, but doesn't move any data around.
+         */
+        void clear()
+        {
+            Utils::for_each_in_tuple(m_Allocators, [&](auto& alloc) {
+                alloc.clear();
+            });
+
+            m_NumObtainedObjects = 0;
+        }
+
         /**
          * Sets a callback to what should happen when an object of type T got deleted
          */
@@ -203,6 +203,28 @@ namespace Memory
                 m_LastInternalHandle = nullptr;
         }
 
+        /**
+         * Marks all elements as free at once. Cheaper than removing them one by one, since nothing has to be moved.
+         */
+        void clear()
+        {
+            size_t num = m_FreeList.getNumObtainedElements();
+            for (size_t i = 0; i < num; i++)
+            {
+                if (m_OnRemoved)
+                    m_OnRemoved(reinterpret_cast<T*>(m_Elements)[i]);
+
+                FLHandle& handle = m_InternalHandles[m_ElementsToInternalHandles[i]];
+
+                // Invalidate all outstanding handles
+                handle.m_Handle.generation++;
+
+                m_FreeList.returnElement(&handle);
+            }
+
+            m_LastInternalHandle = nullptr;
+        }
+
         /**
          * Sets a callback to what should happen when an object got deleted
          */
@@ -0,0 +1,258 @@
+#include "CharacterController.h"
+#include "PhysicsSystem.h"
+#include <algorithm>
+#include <limits>
+#include <engine/BaseEngine.h>
+#include <engine/World.h>
+#include <engine/WorldMesh.h>
+
+using namespace Physics;
+
+/**
+ * Height of a character from the feet to the top of the head
+ */
+const float CHARACTER_HEIGHT = 1.8f;
+
+/**
+ * Highest ledge a character can walk onto without climbing
+ */
+const float STEP_HEIGHT = 0.4f;
+
+/**
+ * How far below the feet the ground is searched for
+ */
+const float MAX_GROUND_DISTANCE = 100.0f;
+
+/**
+ * Ground steeper than this (about 50 degrees) can't be walked up
+ */
+const float MIN_GROUND_NORMAL_Y = 0.64f;
+
+/**
+ * Distance kept to walls, so the next sweep doesn't start inside of them
+ */
+const float SKIN = 0.02f;
+
+/**
+ * Movements shorter than this don't need a horizontal sweep
+ */
+const float MIN_MOTION = 0.001f;
+
+const float DEFAULT_RADIUS = 0.3f;
+const float MIN_RADIUS = 0.2f;
+const float MAX_RADIUS = 0.35f;
+
+namespace
+{
+    /**
+     * Only reports the closest hit with the static world. Water is passed through,
+     * but the highest water-surface touched on the way is remembered.
+     */
+    struct FilteredConvexResultCallback : public btCollisionWorld::ClosestConvexResultCallback
+    {
+        FilteredConvexResultCallback(const btVector3& from, const btVector3& to)
+            : btCollisionWorld::ClosestConvexResultCallback(from, to)
+            , m_pWorldMesh(nullptr)
+            , m_ShapeAlloc(nullptr)
+            , m_IsWorldMesh(false)
+            , m_TriangleIndex(0)
+            , m_WaterSurfaceY(-std::numeric_limits<float>::max())
+        {
+        }
+
+        btScalar addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace) override
+        {
+            int shapeIndex = convexResult.m_hitCollisionObject->getCollisionShape()->getUserIndex();
+            if (shapeIndex == -1)
+                return m_closestHitFraction;
+
+            // We don't have the generation of the handle here, but it should be okay!
+            Handle::CollisionShapeHandle csh;
+            csh.index = static_cast<uint32_t>(shapeIndex);
+
+            CollisionShape& s = m_ShapeAlloc->getElementForce(csh);
+            if ((s.collisionType & (CollisionShape::CT_WorldMesh | CollisionShape::CT_Object)) == 0)
+                return m_closestHitFraction;
+
+            bool isWorldMesh = s.collisionType == CollisionShape::CT_WorldMesh;
+            uint32_t triangleIndex = convexResult.m_localShapeInfo
+                                         ? static_cast<uint32_t>(convexResult.m_localShapeInfo->m_triangleIndex)
+                                         : 0;
+
+            if (isWorldMesh && m_pWorldMesh->getMaterialGroupOfTriangle(triangleIndex) == ZenLoad::MaterialGroup::WATER)
+            {
+                // Static geometry has an identity-transform, so local and world-space are the same
+                m_WaterSurfaceY = std::max(m_WaterSurfaceY, convexResult.m_hitPointLocal.y());
+                return m_closestHitFraction;
+            }
+
+            m_IsWorldMesh = isWorldMesh;
+            m_TriangleIndex = triangleIndex;
+
+            return btCollisionWorld::ClosestConvexResultCallback::addSingleResult(convexResult, normalInWorldSpace);
+        }
+
+        World::WorldMesh* m_pWorldMesh;
+        CollisionShapeAllocator* m_ShapeAlloc;
+        bool m_IsWorldMesh;
+        uint32_t m_TriangleIndex;
+        float m_WaterSurfaceY;
+    };
+}
+
+CharacterController::CharacterController(PhysicsSystem& physicsSystem)
+    : m_PhysicsSystem(physicsSystem)
+    , m_Radius(0.0f)
+{
+    m_Ground.successful = false;
+    m_Ground.position = Math::float3(0, 0, 0);
+    m_Ground.normal = Math::float3(0, 1, 0);
+    m_Ground.isWorldMesh = false;
+    m_Ground.triangleIndex = 0;
+    m_Ground.waterDepth = 0.0f;
+    m_Ground.blocked = false;
+}
+
+CharacterController::~CharacterController()
+{
+}
+
+void CharacterController::setRadius(float radius)
+{
+    radius = std::min(MAX_RADIUS, std::max(MIN_RADIUS, radius));
+
+    if (m_pShape && radius == m_Radius)
+        return;
+
+    // Cylinder-part of the capsule. The half-spheres are added on top and below.
+    float height = std::max(0.0f, CHARACTER_HEIGHT - STEP_HEIGHT - 2.0f * radius);
+
+    m_pShape.reset(new btCapsuleShape(radius, height));
+    m_Radius = radius;
+}
+
+CharacterController::SweepResult CharacterController::sweep(const Math::float3& from, const Math::float3& to)
+{
+    m_PhysicsSystem.m_World.getEngine()->getMetrics().count(Engine::MetricsServer::C_PhysicsSweeps);
+
+    btVector3 btFrom(from.x, from.y, from.z);
+    btVector3 btTo(to.x, to.y, to.z);
+
+    btTransform tFrom, tTo;
+    tFrom.setIdentity();
+    tFrom.setOrigin(btFrom);
+    tTo.setIdentity();
+    tTo.setOrigin(btTo);
+
+    FilteredConvexResultCallback r(btFrom, btTo);
+    r.m_pWorldMesh = &m_PhysicsSystem.m_World.getWorldMesh();
+    r.m_ShapeAlloc = &m_PhysicsSystem.m_CollisionShapeAllocator;
+
+    m_PhysicsSystem.m_pDynamicsWorld->convexSweepTest(m_pShape.get(), tFrom, tTo, r);
+
+    SweepResult result;
+    result.hasHit = r.hasHit();
+    result.fraction = r.hasHit() ? r.m_closestHitFraction : 1.0f;
+    result.hitPosition = Math::float3(r.m_hitPointWorld.x(), r.m_hitPointWorld.y(), r.m_hitPointWorld.z());
+    result.hitNormal = Math::float3(r.m_hitNormalWorld.x(), r.m_hitNormalWorld.y(), r.m_hitNormalWorld.z());
+    result.isWorldMesh = r.m_IsWorldMesh;
+    result.triangleIndex = r.m_TriangleIndex;
+    result.waterSurfaceY = r.m_WaterSurfaceY;
+
+    return result;
+}
+
+Math::float3 CharacterController::slideAlongWall(const SweepResult& hit, const Math::float3& remaining)
+{
+    // Walls are treated as vertical, so sliding never pushes the character up or down
+    Math::float3 n(hit.hitNormal.x, 0.0f, hit.hitNormal.z);
+    if (n.lengthSquared() < MIN_MOTION * MIN_MOTION)
+        return Math::float3(0, 0, 0);
+
+    n.normalize();
+
+    return remaining - n * remaining.dot(n);
+}
+
+Math::float3 CharacterController::move(const Math::float3& feet, const Math::float3& motion)
+{
+    if (!m_pShape)
+        setRadius(DEFAULT_RADIUS);
+
+    // Center of the capsule, which floats STEP_HEIGHT above the feet
+    float centerHeight = STEP_HEIGHT + (CHARACTER_HEIGHT - STEP_HEIGHT) * 0.5f;
+    Math::float3 center = feet + Math::float3(0.0f, centerHeight, 0.0f);
+
+    Math::float3 horizontal(motion.x, 0.0f, motion.z);
+    bool moved = horizontal.lengthSquared() > MIN_MOTION * MIN_MOTION;
+    bool blocked = false;
+
+    if (moved)
+    {
+        SweepResult wall = sweep(center, center + horizontal);
+
+        if (!wall.hasHit)
+        {
+            center += horizontal;
+        }
+        else
+        {
+            blocked = true;
+
+            // Go as far as possible, then slide along the wall with what's left
+            float length = horizontal.length();
+            float travel = std::max(0.0f, wall.fraction * length - SKIN);
+            center += horizontal * (travel / length);
+
+            Math::float3 slide = slideAlongWall(wall, horizontal * (1.0f - travel / length));
+            float slideLength = slide.length();
+
+            if (slideLength > MIN_MOTION)
+            {
+                SweepResult corner = sweep(center, center + slide);
+                float slideTravel = corner.hasHit ? std::max(0.0f, corner.fraction * slideLength - SKIN) : slideLength;
+                center += slide * (slideTravel / slideLength);
+            }
+        }
+    }
+
+    // Drop down onto the ground. This also walks up steps and slopes, since the capsule starts above them.
+    Math::float3 down = center - Math::float3(0.0f, STEP_HEIGHT + MAX_GROUND_DISTANCE, 0.0f);
+    SweepResult ground = sweep(center, down);
+
+    if (!ground.hasHit)
+    {
+        m_Ground.successful = false;
+        m_Ground.waterDepth = 0.0f;
+        m_Ground.blocked = blocked;
+
+        return Math::float3(center.x, feet.y, center.z);
+    }
+
+    // Height of the ground right below the center. The capsule touches slopes off-center.
+    Math::float3 centerAtHit = center + (down - center) * ground.fraction;
+    float groundY = ground.hitPosition.y;
+    if (ground.hitNormal.y > 0.1f)
+    {
+        groundY -= ((centerAtHit.x - ground.hitPosition.x) * ground.hitNormal.x +
+                    (centerAtHit.z - ground.hitPosition.z) * ground.hitNormal.z) /
+                   ground.hitNormal.y;
+    }
+
+    // Don't walk up slopes which are too steep. Keep the old ground then, nothing changed below the feet.
+    if (moved && ground.hitNormal.y < MIN_GROUND_NORMAL_Y && groundY > feet.y + SKIN)
+    {
+        m_Ground.blocked = true;
+        return feet;
+    }
+
+    m_Ground.successful = true;
+    m_Ground.position = Math::float3(centerAtHit.x, groundY, centerAtHit.z);
+    m_Ground.normal = ground.hitNormal;
+    m_Ground.isWorldMesh = ground.isWorldMesh;
+    m_Ground.triangleIndex = ground.triangleIndex;
+    m_Ground.waterDepth = std::max(0.0f, ground.waterSurfaceY - groundY);
+    m_Ground.blocked = blocked;
+
+    return m_Ground.position;
+}
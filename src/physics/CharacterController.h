@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <math/mathlib.h>
+
+class btCapsuleShape;
+
+namespace Physics
+{
+    class PhysicsSystem;
+
+    /**
+     * Kinematic capsule moving a character over the static world using bullet's convex sweeps.
+     * Resolves walls, steps, slopes and the ground in one go, so the callers don't need to raytrace on their own.
+     *
+     * The capsule floats STEP_HEIGHT above the feet: Everything lower than that is stepped onto by the
+     * sweep down to the ground, everything higher blocks the horizontal movement.
+     */
+    class CharacterController
+    {
+    public:
+        /**
+         * Surface below the character, as found by the last move
+         */
+        struct GroundInfo
+        {
+            /**
+             * Whether there is ground below the character at all. Everything else is invalid otherwise.
+             */
+            bool successful;
+
+            /**
+             * Point on the ground right below the characters feet
+             */
+            Math::float3 position;
+
+            /**
+             * Normal of the surface touched
+             */
+            Math::float3 normal;
+
+            /**
+             * Whether the ground is part of the worldmesh. If not, it's some static object.
+             */
+            bool isWorldMesh;
+
+            /**
+             * Index of the touched triangle inside the worldmesh. Only valid if isWorldMesh is set.
+             */
+            uint32_t triangleIndex;
+
+            /**
+             * Distance from the ground up to the water-surface, 0 if not in water.
+             * Only water-surfaces up to STEP_HEIGHT above the feet are seen.
+             */
+            float waterDepth;
+
+            /**
+             * Whether the last move was cut short by a wall or a slope too steep to walk up
+             */
+            bool blocked;
+        };
+
+        CharacterController(PhysicsSystem& physicsSystem);
+        ~CharacterController();
+
+        /**
+         * Sets the radius of the capsule. Doesn't do anything if the radius didn't change.
+         * @param radius Radius of the capsule in meters. Gets clamped to a sensible range.
+         */
+        void setRadius(float radius);
+
+        /**
+         * Moves the character by the given offset, sliding along walls and snapping onto the ground
+         * @param feet Current position of the characters feet
+         * @param motion Offset to move by. Only the horizontal part is used, the height comes from the ground.
+         * @return New position of the feet
+         */
+        Math::float3 move(const Math::float3& feet, const Math::float3& motion);
+
+        /**
+         * @return Ground found by the last call to move()
+         */
+        const GroundInfo& getGround() const { return m_Ground; }
+
+    private:
+        struct SweepResult
+        {
+            bool hasHit;
+            float fraction;
+            Math::float3 hitPosition;
+            Math::float3 hitNormal;
+            bool isWorldMesh;
+            uint32_t triangleIndex;
+            float waterSurfaceY;
+        };
+
+        /**
+         * Sweeps the capsule between the given center-positions through the static world.
+         * Water-surfaces are passed through, only their height is reported.
+         */
+        SweepResult sweep(const Math::float3& from, const Math::float3& to);
+
+        /**
+         * @return Horizontal offset which doesn't go into the wall hit by the given sweep
+         */
+        Math::float3 slideAlongWall(const SweepResult& hit, const Math::float3& remaining);
+
+        PhysicsSystem& m_PhysicsSystem;
+        std::unique_ptr<btCapsuleShape> m_pShape;
+        float m_Radius;
+        GroundInfo m_Ground;
+    };
+}
@@ -7,6 +7,7 @@
 #include <BulletCollision/CollisionShapes/btConvexHullShape.h>
 #include <BulletCollision/CollisionShapes/btShapeHull.h>
 #include <components/EntityActions.h>
+#include <engine/BaseEngine.h>
 #include <engine/World.h>
 #include <logic/Controller.h>
 #include <logic/VisualController.h>
@@ -37,9 +38,25 @@ PhysicsSystem::PhysicsSystem(World::WorldInstance& world, float gravity)
 
 PhysicsSystem::~PhysicsSystem()
 {
+    // Removing the rigid-bodies one by one does a linear search through the world and the sorted
+    // pair-cache each time. Drop all pairs in one pass instead and let the world detach the remaining
+    // broadphase-proxies when it is deleted.
+    struct RemoveAllPairs : public btOverlapCallback
+    {
+        bool processOverlap(btBroadphasePair& pair) override
+        {
+            return true;
+        }
+    } removeAllPairs;
+
+    m_pPairCache->processAllOverlappingPairs(&removeAllPairs, m_pDispatcher);
+
+    delete m_pDynamicsWorld->getDebugDrawer();
+
+    delete m_pDynamicsWorld;
+
     for (size_t i = 0; i < m_PhysicsObjectAllocator.getNumObtainedElements(); i++)
     {
-        m_pDynamicsWorld->removeRigidBody(m_PhysicsObjectAllocator.getElements()[i].rigidBody);
         PhysicsObject::clean(m_PhysicsObjectAllocator.getElements()[i]);
     }
 
@@ -48,9 +65,6 @@ PhysicsSystem::~PhysicsSystem()
         CollisionShape::clean(m_CollisionShapeAllocator.getElements()[i]);
     }
 
-    delete m_pDynamicsWorld->getDebugDrawer();
-
-    delete m_pDynamicsWorld;
     delete m_pSolver;
     delete m_pDispatcher;
     delete m_pCollisionConfiguration;
@@ -156,33 +170,27 @@ Handle::CollisionShapeHandle PhysicsSystem::makeCollisionShapeFromMesh(const Mes
     return csh;
 }
 
-Handle::CollisionShapeHandle PhysicsSystem::makeCollisionShapeFromMesh(const std::vector<ZenLoad::WorldTriangle>& triangles,
-                                                                       CollisionShape::ECollisionType type,
-                                                                       const std::string& name)
+Handle::CollisionShapeHandle PhysicsSystem::makeCollisionShapeFromIndexedMesh(const std::vector<Math::float3>& positions,
+                                                                              const std::vector<uint32_t>& indices,
+                                                                              CollisionShape::ECollisionType type,
+                                                                              const std::string& name)
 {
+    static_assert(sizeof(Math::float3) == 3 * sizeof(btScalar), "Vertex-positions must be usable by bullet as they are");
+
     if (m_ShapeCache.find(name) != m_ShapeCache.end())
         return m_ShapeCache[name];
 
-    // Init collision
-    btTriangleMesh* wm = new btTriangleMesh;
-
-    wm->preallocateVertices((int)triangles.size() * 3);
-    for (size_t i = 0; i < triangles.size(); i++)
-    {
-        // Convert to btvector
-        const btVector3 v[] = {
-            {triangles[i].vertices[0].Position.x, triangles[i].vertices[0].Position.y, triangles[i].vertices[0].Position.z},
-            {triangles[i].vertices[1].Position.x, triangles[i].vertices[1].Position.y, triangles[i].vertices[1].Position.z},
-            {triangles[i].vertices[2].Position.x, triangles[i].vertices[2].Position.y, triangles[i].vertices[2].Position.z}};
-
-        wm->addTriangle(v[0], v[1], v[2]);
-    }
-
-    if (wm->getNumTriangles() == 0)
-    {
-        delete wm;
+    if (indices.size() < 3 || positions.empty())
         return Handle::CollisionShapeHandle::makeInvalidHandle();
-    }
+
+    // Only references the data, unlike btTriangleMesh which would copy every triangle
+    btTriangleIndexVertexArray* wm = new btTriangleIndexVertexArray(
+        static_cast<int>(indices.size() / 3),
+        reinterpret_cast<int*>(const_cast<uint32_t*>(indices.data())),
+        static_cast<int>(3 * sizeof(uint32_t)),
+        static_cast<int>(positions.size()),
+        reinterpret_cast<btScalar*>(const_cast<Math::float3*>(positions.data())),
+        static_cast<int>(sizeof(Math::float3)));
 
     Handle::CollisionShapeHandle csh = m_CollisionShapeAllocator.createObject();
     CollisionShape& cs = getCollisionShape(csh);
@@ -249,6 +257,8 @@ Handle::CollisionShapeHandle PhysicsSystem::makeBoxCollisionShape(const Math::fl
 
 std::vector<RayTestResult> PhysicsSystem::raytraceAll(const Math::float3& from, const Math::float3& to, CollisionShape::ECollisionType filtertype)
 {
+    m_World.getEngine()->getMetrics().count(Engine::MetricsServer::C_PhysicsRaytraces);
+
     struct FilteredAllHitsRayResultCallback : public btCollisionWorld::RayResultCallback
     {
         FilteredAllHitsRayResultCallback(const btVector3& rayFromWorld, const btVector3& rayToWorld)
@@ -344,6 +354,8 @@ std::vector<RayTestResult> PhysicsSystem::raytraceAll(const Math::float3& from,
 
 RayTestResult PhysicsSystem::raytrace(const Math::float3& from, const Math::float3& to, CollisionShape::ECollisionType filtertype)
 {
+    m_World.getEngine()->getMetrics().count(Engine::MetricsServer::C_PhysicsRaytraces);
+
     /*btVector3 btFrom(from.x, from.y, from.z);
     btVector3 btTo(to.x, to.y, to.z);
     btCollisionWorld::ClosestRayResultCallback res(btFrom, btTo);
@@ -512,6 +524,20 @@ void PhysicsSystem::compoundShapeAddChild(Handle::CollisionShapeHandle target, H
     compShape->addChildShape(btr, cs.collisionShape);
 }
 
+void PhysicsSystem::compoundShapeRemoveAllChildren(Handle::CollisionShapeHandle target)
+{
+    CollisionShape& ts = getCollisionShape(target);
+
+    assert(ts.shapeType == CollisionShape::Compound);
+
+    btCompoundShape* compShape = reinterpret_cast<btCompoundShape*>(ts.collisionShape);
+
+    for (int i = compShape->getNumChildShapes() - 1; i >= 0; i--)
+        compShape->removeChildShapeByIndex(i);
+
+    compShape->recalculateLocalAabb();
+}
+
 void PhysicsSystem::postProcessLoad()
 {
     m_pDynamicsWorld->updateAabbs();
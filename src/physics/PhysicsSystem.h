@@ -95,6 +95,7 @@ namespace Physics
     class PhysicsSystem
     {
         friend class RigidBody;
+        friend class CharacterController;
 
     public:
         PhysicsSystem(World::WorldInstance& world, float gravity = -9.1f);
@@ -127,7 +128,16 @@ namespace Physics
          * @return Static collision-shape using this mesh
          */
         Handle::CollisionShapeHandle makeCollisionShapeFromMesh(const Meshes::WorldStaticMesh& mesh, CollisionShape::ECollisionType type = CollisionShape::CT_Any, const std::string& name = "");
-        Handle::CollisionShapeHandle makeCollisionShapeFromMesh(const std::vector<ZenLoad::WorldTriangle>& triangles, CollisionShape::ECollisionType type = CollisionShape::CT_Any, const std::string& name = "");
+
+        /**
+         * Creates a new collisionshape referencing the given indexed triangles. Nothing is copied, so
+         * positions and indices must not be changed or freed while the shape exists.
+         * Triangle-indices reported by raytests are the ones of the given index-list.
+         * @param positions Vertex-positions
+         * @param indices 3 indices per triangle into positions
+         * @return Static collision-shape using the triangles
+         */
+        Handle::CollisionShapeHandle makeCollisionShapeFromIndexedMesh(const std::vector<Math::float3>& positions, const std::vector<uint32_t>& indices, CollisionShape::ECollisionType type = CollisionShape::CT_Any, const std::string& name = "");
 
         /**
          * Creates a box-like collision-shape
@@ -168,6 +178,12 @@ namespace Physics
          */
         void compoundShapeAddChild(Handle::CollisionShapeHandle target, Handle::CollisionShapeHandle childShape, const Math::Matrix& localTransform = Math::Matrix::CreateIdentity());
 
+        /**
+         * Removes all child-shapes from the given compound-shape. The children themselves stay alive.
+         * @param target Compound-shape to clear
+         */
+        void compoundShapeRemoveAllChildren(Handle::CollisionShapeHandle target);
+
         /**
          * Deletes a collisionshape from the cache
          */
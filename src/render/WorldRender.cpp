@@ -16,6 +16,9 @@
 #include <content/StaticMeshAllocator.h>
 #include <components/AnimHandler.h>
 #include <engine/BaseEngine.h>
+#include <engine/LooseItems.h>
+#include <logic/PfxManager.h>
+#include <logic/ProjectileManager.h>
 
 enum class ECameraClipType
 {
@@ -103,6 +106,10 @@ namespace Render
 
         auto& meshes = world.getStaticMeshAllocator();
         auto& skelmeshes = world.getSkeletalMeshAllocator();
+        auto& textures = world.getTextureAllocator();
+
+        // Animated textures all run on the same clock, so there is nothing to update per material
+        double textureAnimationTime = world.getEngine()->getGameClock().getTotalSecondsRealtime();
         Components::StaticMeshComponent* sms = std::get<Components::StaticMeshComponent*>(ctuple);
         Components::PositionComponent* psc = std::get<Components::PositionComponent*>(ctuple);
         Components::EntityComponent* ents = std::get<Components::EntityComponent*>(ctuple);
@@ -227,7 +234,7 @@ namespace Render
 
                     if (sms[i].m_Texture.isValid())
                     {
-                        Textures::Texture& texture = world.getTextureAllocator().getTexture(sms[i].m_Texture);
+                        Textures::Texture& texture = textures.getTexture(textures.getAnimationFrame(sms[i].m_Texture, textureAnimationTime));
                         bgfx::setTexture(0, config.uniforms.diffuseTexture, texture.m_TextureHandle, textureFlags);
                     }
 
@@ -331,7 +338,7 @@ namespace Render
 
                         if (sms[i].m_Texture.isValid())
                         {
-                            Textures::Texture& texture = world.getTextureAllocator().getTexture(sms[i].m_Texture);
+                            Textures::Texture& texture = textures.getTexture(textures.getAnimationFrame(sms[i].m_Texture, textureAnimationTime));
                             bgfx::setTexture(0, config.uniforms.diffuseTexture, texture.m_TextureHandle, textureFlags);
                         }
 
@@ -394,6 +401,119 @@ namespace Render
             }
         }
 
+        // Loose items share the mesh of their visual and only bring their own transform
+        const World::LooseItems& looseItems = world.getLooseItems();
+        for (const World::LooseItems::ItemRecord& item : looseItems.getItems())
+        {
+            const World::LooseItems::ItemVisual& visual = looseItems.getVisual(item.visual);
+            Meshes::WorldStaticMesh& mesh = meshes.getMesh(visual.mesh);
+
+            // Could happen if this was loaded on another thread
+            if (!mesh.loaded)
+                continue;
+
+            Math::float3 position = item.transform.Translation();
+            if ((position - cameraPosition).lengthSquared() > drawDistance2 * visual.drawDistanceFactor)
+                continue;
+
+            if (frustrumContainsSphere(frustumPlanes, position, mesh.boundingSphereRadius) == ECameraClipType::Out)
+                continue;
+
+            Math::float4 color(item.shadow, item.shadow, item.shadow, 1.0f);
+
+            for (size_t s = 0; s < mesh.mesh.m_SubmeshStarts.size(); s++)
+            {
+                bgfx::setTransform(item.transform.m);
+                bgfx::setState(BGFX_STATE_DEFAULT);
+
+                if (visual.textures[s].isValid())
+                {
+                    Textures::Texture& texture = textures.getTexture(textures.getAnimationFrame(visual.textures[s], textureAnimationTime));
+                    bgfx::setTexture(0, config.uniforms.diffuseTexture, texture.m_TextureHandle, textureFlags);
+                }
+
+                bgfx::setUniform(config.uniforms.objectColor, color.v);
+
+                if (mesh.mesh.m_IndexBufferHandle.idx != bgfx::kInvalidHandle)
+                {
+                    bgfx::setVertexBuffer(0, mesh.mesh.m_VertexBufferHandle);
+                    bgfx::setIndexBuffer(mesh.mesh.m_IndexBufferHandle,
+                                         mesh.mesh.m_SubmeshStarts[s].m_StartIndex,
+                                         mesh.mesh.m_SubmeshStarts[s].m_NumIndices);
+                }
+                else
+                {
+                    bgfx::setVertexBuffer(0, mesh.mesh.m_VertexBufferHandle,
+                                          mesh.mesh.m_SubmeshStarts[s].m_StartIndex,
+                                          mesh.mesh.m_SubmeshStarts[s].m_NumIndices);
+                }
+
+                bgfx::submit(RenderViewList::DEFAULT, config.programs.mainWorldProgram);
+
+                numIndices += mesh.mesh.m_SubmeshStarts[s].m_NumIndices;
+                numDrawcalls++;
+                numSubmeshesDrawn++;
+            }
+        }
+
+        // Projectiles come already grouped by visual
+        const Math::float4 projectileColor(1.0f, 1.0f, 1.0f, 1.0f);
+        for (const Logic::ProjectileManager::ProjectileVisual& visual : world.getProjectileManager().getVisuals())
+        {
+            if (visual.instances.empty())
+                continue;
+
+            Meshes::WorldStaticMesh& mesh = meshes.getMesh(visual.mesh);
+
+            // Could happen if this was loaded on another thread
+            if (!mesh.loaded)
+                continue;
+
+            for (const Math::Matrix& transform : visual.instances)
+            {
+                Math::float3 position = transform.Translation();
+                if ((position - cameraPosition).lengthSquared() > drawDistance2)
+                    continue;
+
+                if (frustrumContainsSphere(frustumPlanes, position, mesh.boundingSphereRadius) == ECameraClipType::Out)
+                    continue;
+
+                for (size_t s = 0; s < mesh.mesh.m_SubmeshStarts.size(); s++)
+                {
+                    bgfx::setTransform(transform.m);
+                    bgfx::setState(BGFX_STATE_DEFAULT);
+
+                    if (visual.textures[s].isValid())
+                    {
+                        Textures::Texture& texture = textures.getTexture(textures.getAnimationFrame(visual.textures[s], textureAnimationTime));
+                        bgfx::setTexture(0, config.uniforms.diffuseTexture, texture.m_TextureHandle, textureFlags);
+                    }
+
+                    bgfx::setUniform(config.uniforms.objectColor, projectileColor.v);
+
+                    if (mesh.mesh.m_IndexBufferHandle.idx != bgfx::kInvalidHandle)
+                    {
+                        bgfx::setVertexBuffer(0, mesh.mesh.m_VertexBufferHandle);
+                        bgfx::setIndexBuffer(mesh.mesh.m_IndexBufferHandle,
+                                             mesh.mesh.m_SubmeshStarts[s].m_StartIndex,
+                                             mesh.mesh.m_SubmeshStarts[s].m_NumIndices);
+                    }
+                    else
+                    {
+                        bgfx::setVertexBuffer(0, mesh.mesh.m_VertexBufferHandle,
+                                              mesh.mesh.m_SubmeshStarts[s].m_StartIndex,
+                                              mesh.mesh.m_SubmeshStarts[s].m_NumIndices);
+                    }
+
+                    bgfx::submit(RenderViewList::DEFAULT, config.programs.mainWorldProgram);
+
+                    numIndices += mesh.mesh.m_SubmeshStarts[s].m_NumIndices;
+                    numDrawcalls++;
+                    numSubmeshesDrawn++;
+                }
+            }
+        }
+
 // Now draw instances
 #if 0
 		for(size_t i=0;i<instanceKindIdx;i++)
@@ -524,6 +644,9 @@ void ::Render::drawPfx(World::WorldInstance& world, Components::PfxComponent& pf
 {
     // TODO: Could optimize this into a global vertexbuffer
 
+    // Let the simulation know someone is looking
+    pfx.m_LastDrawnFrame = world.getPfxManager().getFrame();
+
     if (!bgfx::isValid(pfx.m_ParticleVB))
         return;
 
@@ -600,24 +723,13 @@ void ::Render::drawPfx(World::WorldInstance& world, Components::PfxComponent& pf
 
 static ECameraClipType frustrumContainsSphere(const Plane* frustumPlanes, const Math::float3& sphereCenter, float sphereRadius)
 {
-    // various distances
-    float fDistance;
+    static_assert(sizeof(Plane) == 4 * sizeof(float), "Planes must be packed as (normal, distance)");
 
-    // calculate our distances to each of the planes
-    for(int i = 0; i < 6; ++i) {
+    // Check all planes, so spheres crossing one plane but being behind another one get culled as well
+    int r = Math::Simd::classifySphere(&frustumPlanes[0].m_normal[0], 6, sphereCenter.x, sphereCenter.y, sphereCenter.z, sphereRadius);
 
-        // find the distance to this plane
-        fDistance = Math::float3(frustumPlanes[i].m_normal).dot(sphereCenter) + frustumPlanes[i].m_dist;
-
-        // if this distance is < -sphere.radius, we are outside
-        if(fDistance < -sphereRadius)
-            return ECameraClipType::Out;
-
-        // else if the distance is between +- radius, then we intersect
-        if((float)fabs(fDistance) < sphereRadius)
-            return ECameraClipType::Crossing;
-    }
+    if (r < 0)
+        return ECameraClipType::Out;
 
-    // otherwise we are fully in view
-    return ECameraClipType::In;
+    return r == 0 ? ECameraClipType::Crossing : ECameraClipType::In;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
  * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
  */
 
+#include <chrono>
+#include <cmath>
 #include <fstream>
 #include "rgconfig.h"
 #include <common.h>
@@ -18,6 +20,10 @@
 #include <logic/NpcScriptState.h>
 #include <logic/PlayerController.h>
 #include <logic/MusicController.h>
+#include <logic/NpcPool.h>
+#include <engine/RouteCache.h>
+#include <logic/PfxManager.h>
+#include <logic/ProjectileManager.h>
 #include <logic/SavegameManager.h>
 #include <logic/visuals/ModelVisual.h>
 #include <render/RenderSystem.h>
@@ -48,6 +54,7 @@ namespace Flags
 {
     Cli::Flag help("h", "help", 0, "Prints this message");
     Cli::Flag vsync("vsync", "vertical-sync", 0, "Enables vertical sync", {"0"}, "Rendering");
+    Cli::Flag exec("", "exec", 1, "Runs the console-commands of the given file after startup, ie. a performance-scenario", {""}, "Debug");
 }
 
 void REGoth::init(int _argc, char** _argv)
@@ -104,6 +111,9 @@ void REGoth::init(int _argc, char** _argv)
     // Init SavegameManager
     Engine::SavegameManager::init(*m_pEngine);
 
+    // Build the other menus during the next frames, so they open without a hitch later
+    m_pEngine->getHud().prewarmMenus();
+
     if (m_pEngine->getEngineArgs().startNewGame)
     {
         menuMain.onCustomAction("NEW_GAME");
@@ -122,6 +132,9 @@ void REGoth::init(int _argc, char** _argv)
 
     initConsole();
 
+    if (!Flags::exec.getParam(0).empty())
+        m_pEngine->getConsole().getScript().load(Flags::exec.getParam(0));
+
     imguiCreate(fontSize);
     m_ImgUiCreated = true;
     m_scrollArea = 0;
@@ -187,6 +200,152 @@ void REGoth::initConsole()
         });
 
 
+    console.registerCommand("npcpool", [this](const std::vector<std::string>& args) -> std::string {
+        const Logic::NpcPool& pool = m_pEngine->getMainWorld().get().getNpcPool();
+
+        std::stringstream ss;
+        ss << "NPC-Pool of the current world:" << std::endl
+           << "   - Pooled: " << pool.getNumPooled() << std::endl
+           << "   - Hits: " << pool.getStats().hits << ", Misses: " << pool.getStats().misses << std::endl
+           << "   - Released: " << pool.getStats().released << ", Discarded: " << pool.getStats().discarded << std::endl;
+
+        LogInfo() << ss.str();
+        return ss.str();
+    });
+
+    console.registerCommand("routecache", [this](const std::vector<std::string>& args) -> std::string {
+        const World::RouteCache& cache = m_pEngine->getMainWorld().get().getRouteCache();
+
+        std::stringstream ss;
+        ss << "Route-Cache of the current world:" << std::endl
+           << "   - Cached routes: " << cache.getNumRoutes() << std::endl
+           << "   - Hits: " << cache.getStats().hits << ", Misses: " << cache.getStats().misses
+           << " (Hit-rate: " << static_cast<int>(cache.getHitRate() * 100.0f) << "%)" << std::endl
+           << "   - Evictions: " << cache.getStats().evictions << ", Invalidations: " << cache.getStats().invalidations << std::endl;
+
+        LogInfo() << ss.str();
+        return ss.str();
+    });
+
+    console.registerCommand("benchmark", [this](const std::vector<std::string>& args) -> std::string {
+        if (args.size() < 2 || (args[1] != "math" && args[1] != "projectiles"))
+            return "Usage: benchmark <math|projectiles> [iterations]";
+
+        if (args[1] == "projectiles")
+        {
+            size_t count = args.size() > 2 ? static_cast<size_t>(std::max(1, atoi(args[2].c_str()))) : 5000;
+
+            World::WorldInstance& world = m_pEngine->getMainWorld().get();
+
+            // Own manager without damage, so neither the NPCs hit nor the projectiles already flying are touched
+            Logic::ProjectileManager projectiles(world, false);
+
+            Handle::EntityHandle player = world.getScriptEngine().getPlayerEntity();
+            if (!player.isValid())
+                return "No player in the world";
+
+            Math::float3 center = world.getEntity<Components::PositionComponent>(player).m_WorldMatrix.Translation();
+
+            // Volleys from all around the player, flat enough to hit NPCs and walls alike
+            size_t numFired = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                float angle = Utils::frand() * 2.0f * Math::PI;
+                float elevation = Utils::frandF2() * 0.2f;
+                Math::float3 position = center + Math::float3(Utils::frandF2() * 30.0f, 1.5f, Utils::frandF2() * 30.0f);
+                Math::float3 velocity = Math::float3(std::cos(angle), elevation, std::sin(angle)) * 50.0f;
+
+                if (projectiles.fire("ITRW_ARROW.3DS", position, velocity, player, i % 2 == 0))
+                    numFired++;
+            }
+
+            const size_t numUpdates = 300;
+            const double dt = 1.0 / 60.0;
+
+            double total = 0.0, worst = 0.0;
+            size_t worldTests = 0, npcHits = 0;
+            for (size_t i = 0; i < numUpdates; i++)
+            {
+                auto start = std::chrono::high_resolution_clock::now();
+                projectiles.update(dt);
+                auto end = std::chrono::high_resolution_clock::now();
+
+                double ms = std::chrono::duration<double, std::milli>(end - start).count();
+                total += ms;
+                worst = std::max(worst, ms);
+
+                worldTests += projectiles.getStats().worldTests;
+                npcHits += projectiles.getStats().npcHits;
+            }
+
+            size_t numStuck = projectiles.getStats().stuck;
+
+            std::stringstream ss;
+            ss << "Projectile-benchmark, " << numFired << " projectiles over " << numUpdates << " updates:" << std::endl
+               << "   - Time per update: " << (total / numUpdates) << " ms (worst: " << worst << " ms)" << std::endl
+               << "   - World tests: " << worldTests << std::endl
+               << "   - NPC hits: " << npcHits << ", stuck at the end: " << numStuck << std::endl;
+
+            LogInfo() << ss.str();
+            return ss.str();
+        }
+
+        size_t iterations = args.size() > 2 ? static_cast<size_t>(std::max(1, atoi(args[2].c_str()))) : 1000000;
+
+        // Random, well conditioned matrices, so the inverse is stable
+        const size_t numMatrices = 64;
+        std::vector<Math::Matrix> matrices(numMatrices);
+        for (Math::Matrix& m : matrices)
+        {
+            m = Math::Matrix::CreateFromAxisAngle(Math::float3(Utils::frandF2(), Utils::frandF2(), 1.0f).normalize(), Utils::frand() * Math::PI)
+                * Math::Matrix::CreateTranslation(Utils::frandF2() * 100.0f, Utils::frandF2() * 100.0f, Utils::frandF2() * 100.0f);
+        }
+
+        // Runs the given operation on all matrices and returns the time per call in nanoseconds.
+        // The sink keeps the compiler from throwing the results away.
+        float sink = 0.0f;
+        auto measure = [&](auto fn) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < iterations; i++)
+                sink += fn(matrices[i % numMatrices], matrices[(i + 1) % numMatrices]);
+
+            auto end = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+        };
+
+        double mulScalar = measure([](const Math::Matrix& a, const Math::Matrix& b) { return Math::Matrix(a._glmMatrix * b._glmMatrix)._11; });
+        double mulSimd = measure([](const Math::Matrix& a, const Math::Matrix& b) { return (a * b)._11; });
+        double invScalar = measure([](const Math::Matrix& a, const Math::Matrix& b) { return Math::Matrix(glm::inverse(a._glmMatrix))._11; });
+        double invSimd = measure([](const Math::Matrix& a, const Math::Matrix& b) { return a.Invert()._11; });
+        double trScalar = measure([](const Math::Matrix& a, const Math::Matrix& b) { return (a._glmMatrix * glm::vec4(b._41, b._42, b._43, 1.0f)).x; });
+        double trSimd = measure([](const Math::Matrix& a, const Math::Matrix& b) { return (a * b.Translation()).x; });
+
+        // Make sure both implementations agree
+        float maxError = 0.0f;
+        for (size_t i = 0; i < numMatrices; i++)
+        {
+            const Math::Matrix& a = matrices[i];
+            const Math::Matrix& b = matrices[(i + 1) % numMatrices];
+            Math::Matrix m1 = a * b;
+            Math::Matrix m2 = a._glmMatrix * b._glmMatrix;
+            Math::Matrix i1 = a.Invert();
+            Math::Matrix i2 = glm::inverse(a._glmMatrix);
+
+            for (size_t j = 0; j < 16; j++)
+                maxError = std::max(maxError, std::max(std::abs(m1.mv[j] - m2.mv[j]), std::abs(i1.mv[j] - i2.mv[j])));
+        }
+
+        std::stringstream ss;
+        ss << "Math-benchmark, " << iterations << " iterations (ns per call, scalar / simd):" << std::endl
+           << "   - Matrix * Matrix: " << mulScalar << " / " << mulSimd << std::endl
+           << "   - Matrix::Invert: " << invScalar << " / " << invSimd << std::endl
+           << "   - Matrix * float3: " << trScalar << " / " << trSimd << std::endl
+           << "   - Max. difference: " << maxError << " (Checksum: " << sink << ")" << std::endl;
+
+        LogInfo() << ss.str();
+        return ss.str();
+    });
+
     console.registerCommand("stats", [](const std::vector<std::string>& args) -> std::string {
         static bool s_Stats = false;
         s_Stats = !s_Stats;
@@ -830,7 +989,7 @@ void REGoth::initConsole()
         if (!World::Waynet::waypointExists(worldInstance.getWaynet(), spawnpoint) && !worldInstance.doesFreepointExist(spawnpoint))
             return "Invalid spawnpoint: " + spawnpoint;
 
-        se.getVM().getGameState().insertNPC(datFile.getSymbolIndexByName(name), spawnpoint);
+        VobTypes::Wld_InsertNpc(worldInstance, datFile.getSymbolIndexByName(name), spawnpoint);
         return "Inserting NPC " + name + " at spawnpoint " + spawnpoint;
     });
     insertNPC.registerAutoComplete(npcNamesGen).registerAutoComplete(spawnpointNamesGen);
@@ -1103,6 +1262,23 @@ int REGoth::shutdown()
     return REGothPlatform::shutdown();
 }
 
+bool REGoth::isIdle()
+{
+    if (!m_pEngine)
+        return false;
+
+    return m_pEngine->isPaused() || m_pEngine->getHud().isMenuActive();
+}
+
+bool REGoth::isMeasuring()
+{
+    if (!m_pEngine)
+        return false;
+
+    const Logic::ConsoleScript& script = m_pEngine->getConsole().getScript();
+    return script.isRunning() || script.isMeasuring();
+}
+
 bool REGoth::update()
 {
     std::string frameInputText = getFrameTextInput();
@@ -1149,6 +1325,7 @@ bool REGoth::update()
 
     float time = (float)((now - m_timeOffset) / double(bx::getHPFrequency()));
     const float dt = float(frameTime / freq);
+    const double workTime = std::max(0.0, dt - getLastFrameWaitTime());
 
     Engine::Input::MouseState ms;
     Engine::Input::getMouseState(ms);
@@ -1163,6 +1340,15 @@ bool REGoth::update()
             uint16_t xOffset = static_cast<uint16_t>(m_pEngine->getConsole().isOpen() ? 100 : 0);
             bgfx::dbgTextPrintf(xOffset, 1, 0x4f, "REGoth-Engine (%s)", m_pEngine->getEngineArgs().startupZEN.c_str());
             bgfx::dbgTextPrintf(xOffset, 2, 0x0f, "Frame: % 7.3f[ms] %.1f[fps]", 1000.0 * dt, 1.0f / (double(dt)));
+            bgfx::dbgTextPrintf(xOffset, 3, 0x0f, "%s", m_pEngine->getQualityGovernor().getStatusLine().c_str());
+
+            if (m_pEngine->getMainWorld().isValid())
+            {
+                const Logic::PfxManager& pfxManager = m_pEngine->getMainWorld().get().getPfxManager();
+                const Logic::PfxManager::ParticleStats& stats = pfxManager.getParticleStats();
+                bgfx::dbgTextPrintf(xOffset, 4, 0x0f, "Particles: %d simulated, %d skipped, %d culled (Budget: %d)",
+                                    (int)stats.simulated, (int)stats.skipped, (int)stats.culled, (int)pfxManager.getParticleBudget());
+            }
         }
 
     // This dummy draw call is here to make sure that view 0 is cleared
@@ -1175,7 +1361,7 @@ bool REGoth::update()
 
     ddBegin(0);
 
-        m_pEngine->frameUpdate(dt, (uint16_t)getWindowWidth(), (uint16_t)getWindowHeight());
+        m_pEngine->frameUpdate(dt, workTime, (uint16_t)getWindowWidth(), (uint16_t)getWindowHeight());
         // Draw and process all UI-Views
         // Set render states.
 
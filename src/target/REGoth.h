@@ -20,6 +20,8 @@ public:
     void initConsole();
     int shutdown() override;
     bool update() override;
+    bool isIdle() override;
+    bool isMeasuring() override;
     void drawLog();
     void showSplash();
 
@@ -16,13 +16,16 @@
 #include "TextView.h"
 #include "IntroduceChapterView.h"
 #include <components/VobClasses.h>
+#include <daedalus/DaedalusVM.h>
 #include <logic/PlayerController.h>
 #include <logic/CameraController.h>
 #include <utils/logger.h>
 #include <logic/ScriptEngine.h>
+#include <utils/Utils.h>
 
 UI::Hud::Hud(Engine::BaseEngine& e)
     : View(e)
+    , m_pMenuVM(nullptr)
 {
     Textures::TextureAllocator& alloc = m_Engine.getEngineTextureAlloc();
 
@@ -127,6 +130,12 @@ UI::Hud::~Hud()
 
     popAllMenus();
 
+    for (auto& m : m_MenuCache)
+        delete m.second;
+
+    // Menus keep pointers into the VM, free it last
+    delete m_pMenuVM;
+
     delete m_pHealthBar;
     delete m_pManaBar;
     delete m_pEnemyHealthBar;
@@ -140,8 +149,12 @@ UI::Hud::~Hud()
 
 void UI::Hud::update(double dt, Engine::Input::MouseState& mstate, Render::RenderConfig& config)
 {
-    // Free old menus
-    cleanMenus();
+    // Build one of the menus waiting for it. Only one per frame to keep the frame short.
+    if (!m_MenusToPrewarm.empty())
+    {
+        m_MenusToPrewarm.front()();
+        m_MenusToPrewarm.pop_front();
+    }
 
     // Only draw last menu in the menu-chain
     if (!m_MenuChain.empty())
@@ -301,15 +314,9 @@ void UI::Hud::onInputAction(Engine::ActionType action)
             m_Engine.getSession().enableActionBindings(false);
             return;
         case ActionType::UI_ToggleStatusMenu:
-        {
-            UI::Menu_Status& statsScreen = pushMenu<UI::Menu_Status>();
-            // TODO: Refactor move this into menu_status.create/new function?
-            // Update the players status menu once
-            auto& s = m_Engine.getMainWorld().get().getScriptEngine();
-            VobTypes::NpcVobInformation player = VobTypes::asNpcVob(m_Engine.getMainWorld().get(), s.getPlayerEntity());
-            player.playerController->updateStatusScreen(statsScreen);
+            // Filled with the players values in Menu_Status::onShow()
+            pushMenu<UI::Menu_Status>();
             return;
-        }
         case ActionType::UI_ToggleLogMenu:
         {
             LogInfo() << "Open log";
@@ -329,9 +336,7 @@ void UI::Hud::setGameplayHudVisible(bool value)
 
 void UI::Hud::popMenu()
 {
-    // Move to other list to delete in the next frame. This makes it possible for menus to close themselves.
-    m_MenusToDelete.push_back(m_MenuChain.back());
-
+    // Menus stay alive in the cache, so they can also close themselves
     removeChild(m_MenuChain.back());
     m_MenuChain.pop_back();
     if (m_MenuChain.empty())
@@ -341,12 +346,35 @@ void UI::Hud::popMenu()
     }
 }
 
-void UI::Hud::cleanMenus()
+void UI::Hud::prewarmMenus()
 {
-    for (Menu* m : m_MenusToDelete)
-        delete m;
+    m_MenusToPrewarm.push_back([this]() { getMenu<Menu_Status>(); });
+    m_MenusToPrewarm.push_back([this]() { getMenu<Menu_Log>(); });
+    m_MenusToPrewarm.push_back([this]() { getMenu<Menu_Main>(); });
+    m_MenusToPrewarm.push_back([this]() { getMenu<Menu_Load>(); });
+    m_MenusToPrewarm.push_back([this]() { getMenu<Menu_Save>(); });
+    m_MenusToPrewarm.push_back([this]() { getMenu<Menu_Settings>(); });
+}
+
+Daedalus::DaedalusVM* UI::Hud::getMenuVM()
+{
+    if (m_pMenuVM)
+        return m_pMenuVM;
+
+    std::string datPath = "/_work/data/Scripts/_compiled/MENU.DAT";
+    std::string datFile = Utils::getCaseSensitivePath(datPath, m_Engine.getEngineArgs().gameBaseDirectory);
+
+    if (!Utils::fileExists(datFile))
+    {
+        LogError() << "Failed to find MENU.DAT at: " << datFile;
+        return nullptr;
+    }
+
+    // Load DAT-File...
+    m_pMenuVM = new Daedalus::DaedalusVM(datFile);
+    Daedalus::registerGothicEngineClasses(*m_pMenuVM);
 
-    m_MenusToDelete.clear();
+    return m_pMenuVM;
 }
 
 void UI::Hud::popAllMenus()
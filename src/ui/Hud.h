@@ -1,6 +1,11 @@
 #pragma once
 #include "Menu.h"
 #include "View.h"
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <map>
+#include <typeindex>
 #include <engine/BaseEngine.h>
 #include <engine/Input.h>
 #include <logic/Console.h>
@@ -113,22 +118,39 @@ namespace UI
         void setGameplayHudVisible(bool value);
 
         /**
-         * Appends a menu to the current menu-chain.
+         * Appends a menu to the current menu-chain. Menus are only built once and kept for the whole session,
+         * showing one again only refreshes its contents.
          * @tparam T Type of menu to append. Must have a static 'create' function!
          */
         template <typename T>
         T& pushMenu();
 
         /**
-         * Pops the last menu from the chain and frees its memory.
+         * Pops the last menu from the chain. The menu itself is kept to be shown again later.
          */
         void popMenu();
 
         /**
-         * Pops all menus from the chain and frees its memory.
+         * Pops all menus from the chain
          */
         void popAllMenus();
 
+        /**
+         * @return The menu of the given type, building it if that hasn't been done yet
+         */
+        template <typename T>
+        T& getMenu();
+
+        /**
+         * Builds all menus which can be opened during gameplay, one per frame, so opening them later is instant
+         */
+        void prewarmMenus();
+
+        /**
+         * @return VM running the MENU.DAT, shared by all menus. Loaded on first use, nullptr if MENU.DAT is missing.
+         */
+        Daedalus::DaedalusVM* getMenuVM();
+
         template <typename T>
         bool isTopMenu()
         {
@@ -140,11 +162,6 @@ namespace UI
         bool isMenuActive() { return !m_MenuChain.empty(); }
 
     protected:
-        /**
-         * Deletes all menus stored in the m_MenusToDelete-list
-         */
-        void cleanMenus();
-
         /**
          * All views qualifying as used while normal gameplay
          */
@@ -165,7 +182,21 @@ namespace UI
          * Chain of opened menus. Only the last one will be rendered and processed
          */
         std::list<Menu*> m_MenuChain;
-        std::list<Menu*> m_MenusToDelete;  // Menus to be deleted next frame
+
+        /**
+         * Every menu built so far, by type
+         */
+        std::map<std::type_index, Menu*> m_MenuCache;
+
+        /**
+         * Menus still to be built by prewarmMenus(). One is built per frame.
+         */
+        std::list<std::function<void()>> m_MenusToPrewarm;
+
+        /**
+         * VM running the MENU.DAT, see getMenuVM()
+         */
+        Daedalus::DaedalusVM* m_pMenuVM;
 
         /**
          * All menus registered here
@@ -193,9 +224,32 @@ namespace UI
         {
             m_Engine.setPaused(true);
         }
-        T* menu = T::create(m_Engine);
-        m_MenuChain.push_back(menu);
+
+        T& menu = getMenu<T>();
+
+        // Already open further down the chain: Go back to it instead of adding it twice
+        if (std::find(m_MenuChain.begin(), m_MenuChain.end(), &menu) != m_MenuChain.end())
+        {
+            while (m_MenuChain.back() != &menu)
+                popMenu();
+
+            return menu;
+        }
+
+        menu.onShow();
+
+        m_MenuChain.push_back(&menu);
         addChild(m_MenuChain.back());
-        return *menu;
+        return menu;
+    }
+
+    template <typename T>
+    inline T& Hud::getMenu()
+    {
+        auto it = m_MenuCache.find(typeid(T));
+        if (it == m_MenuCache.end())
+            it = m_MenuCache.emplace(typeid(T), T::create(m_Engine)).first;
+
+        return *static_cast<T*>(it->second);
     }
 }
\ No newline at end of file
@@ -26,8 +26,6 @@ UI::Menu::Menu(Engine::BaseEngine& e)
 
 UI::Menu::~Menu()
 {
-    delete m_pVM;
-
     removeChild(m_pBackgroundImage);
     delete m_pBackgroundImage;
 
@@ -166,20 +164,14 @@ bool UI::Menu::loadMenuDAT()
     if (m_pVM)
         return true;  // Nothing to do, already loaded
 
-    std::string datPath = "/_work/data/Scripts/_compiled/MENU.DAT";
-    std::string datFile = Utils::getCaseSensitivePath(datPath, m_Engine.getEngineArgs().gameBaseDirectory);
-
-    if (!Utils::fileExists(datFile))
-    {
-        LogError() << "Failed to find MENU.DAT at: " << datFile;
-        return false;
-    }
+    m_pVM = getHud().getMenuVM();
 
-    // Load DAT-File...
-    m_pVM = new Daedalus::DaedalusVM(datFile);
-    Daedalus::registerGothicEngineClasses(*m_pVM);
+    return m_pVM != nullptr;
+}
 
-    return true;
+void UI::Menu::onShow()
+{
+    m_SelectedItem = 0;
 }
 
 Daedalus::GEngineClasses::C_Menu& UI::Menu::getScriptData()
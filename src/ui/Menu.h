@@ -60,6 +60,12 @@ namespace UI
          */
         virtual bool onInputAction(Engine::ActionType action);
 
+        /**
+         * Called every time this menu is pushed onto the menu-chain. Menus are kept alive between being shown,
+         * so this is where contents which may have changed in the meantime are refreshed.
+         */
+        virtual void onShow();
+
         /**
          * To be called when there was text input since the last frame
          * @param text Characters input since the last frame
@@ -90,13 +96,13 @@ namespace UI
         std::map<Daedalus::GameState::MenuItemHandle, MenuItem*> initializeItems();
 
         /**
-         * Loads the MENU.DAT from the games files and initializes the VM
+         * Fetches the menu-VM from the Hud, which loads the MENU.DAT on first use
          * @return success
          */
         bool loadMenuDAT();
 
         /**
-         * This menus DaedalusVM. These are quite small and every menu can have its own.
+         * VM running the MENU.DAT. Shared by all menus and owned by the Hud.
          */
         Daedalus::DaedalusVM* m_pVM;
 
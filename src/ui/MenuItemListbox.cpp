@@ -21,6 +21,11 @@ MenuItemTypes::MenuItemListbox::MenuItemListbox(Engine::BaseEngine& e, UI::Menu&
     setHidden(true);
 }
 
+MenuItemTypes::MenuItemListbox::~MenuItemListbox()
+{
+    clearTopics();
+}
+
 void MenuItemTypes::MenuItemListbox::update(double dt, Engine::Input::MouseState& mstate, Render::RenderConfig& config)
 {
     if (m_IsHidden)
@@ -71,6 +76,15 @@ bool MenuItemTypes::MenuItemListbox::hasTopics()
         return false;
 }
 
+void MenuItemTypes::MenuItemListbox::clearTopics()
+{
+    for (MenuItemListboxEntry* entry : m_Entries)
+        delete entry;
+
+    m_Entries.clear();
+    m_Selection = 0;
+}
+
 void MenuItemTypes::MenuItemListbox::addTopic(std::string topic_name, const Daedalus::GameState::LogTopic& topic)
 {
     m_Entries.push_back(new MenuItemListboxEntry(m_Engine, m_BaseMenu, m_ScriptHandle, topic_name, topic));
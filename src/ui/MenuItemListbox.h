@@ -17,6 +17,7 @@ namespace UI
         {
         public:
             MenuItemListbox(Engine::BaseEngine& e, Menu& baseMenu, const Daedalus::GameState::MenuItemHandle& scriptHandle);
+            ~MenuItemListbox();
 
             /**
              * Updates/draws the UI-Views
@@ -37,6 +38,11 @@ namespace UI
              */
             bool hasTopics();
 
+            /**
+             * Removes all topics
+             */
+            void clearTopics();
+
             /*
              * Set the focus of view to this listbox by highlighting an entry
              * @param focus Whether to set the focus or not
@@ -22,10 +22,16 @@ Menu_Load* Menu_Load::create(Engine::BaseEngine& e)
     Menu_Load* s = new Menu_Load(e);
     s->initializeInstance("MENU_SAVEGAME_LOAD");
 
-    s->gatherAvailableSavegames();
     return s;
 }
 
+void Menu_Load::onShow()
+{
+    Menu::onShow();
+
+    gatherAvailableSavegames();
+}
+
 void Menu_Load::gatherAvailableSavegames()
 {
     using namespace Engine;
@@ -20,6 +20,11 @@ namespace UI
          */
         void gatherAvailableSavegames();
 
+        /**
+         * Refreshes the slot-labels, savegames may have been written since the last time
+         */
+        void onShow() override;
+
         void onCustomAction(const std::string& action) override;
 
         static constexpr auto const EMPTY_SLOT_DISPLAYNAME = "---";
@@ -23,13 +23,23 @@ Menu_Log* Menu_Log::create(Engine::BaseEngine& e)
     Menu_Log* s = new Menu_Log(e);
     s->initializeInstance("MENU_LOG");
 
-    // Hide content viewer on log opening
-    s->findMenuItem("MENU_ITEM_CONTENT_VIEWER")->setHidden(true);
+    return s;
+}
+
+void Menu_Log::onShow()
+{
+    Menu::onShow();
 
-    s->setTimeAndDay();
-    s->initializeLogEntries();
+    if (!m_MenuHandle.isValid())
+        return;
 
-    return s;
+    m_LogStatus = EMenuLogStatus::CategorySelection;
+
+    // Hide content viewer on log opening
+    findMenuItem("MENU_ITEM_CONTENT_VIEWER")->setHidden(true);
+
+    setTimeAndDay();
+    initializeLogEntries();
 }
 
 void Menu_Log::setTimeAndDay()
@@ -62,6 +72,14 @@ void Menu_Log::initializeLogEntries()
         else if (item.second->getItemScriptData().instanceSymbol == getItemScriptData("MENU_ITEM_LIST_LOG").instanceSymbol)
             listbox_info = dynamic_cast<MenuItemTypes::MenuItemListbox*>(item.second);
 
+    // Drop what was there the last time the log was open
+    for (MenuItemTypes::MenuItemListbox* listbox : {listbox_running, listbox_failed, listbox_old, listbox_info})
+    {
+        listbox->clearTopics();
+        listbox->setFocus(false);
+        listbox->setHidden(true);
+    }
+
     // Set topic entries to listboxes
     const std::map<std::string, Daedalus::GameState::LogTopic>& log = m_Engine.getSession().getLogManager().getPlayerLog();
     for (auto& entry : log)
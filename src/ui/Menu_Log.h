@@ -27,6 +27,11 @@ namespace UI
          */
         bool onInputAction(Engine::ActionType action) override;
 
+        /**
+         * Refreshes time, day and the log entries
+         */
+        void onShow() override;
+
         /**
          * Creates an instance of this class and appends it to the root UI-View
          * @return Instance of the class. Don't forget to delete!
@@ -23,11 +23,17 @@ Menu_Save* Menu_Save::create(Engine::BaseEngine& e)
     Menu_Save* s = new Menu_Save(e);
     s->initializeInstance("MENU_SAVEGAME_SAVE");
 
-    s->gatherAvailableSavegames();
-
     return s;
 }
 
+void Menu_Save::onShow()
+{
+    Menu::onShow();
+
+    m_isWaitingForSaveName = false;
+    gatherAvailableSavegames();
+}
+
 void Menu_Save::performSelectAction(Daedalus::GameState::MenuItemHandle item)
 {
     MenuItem* iData = m_Items[item];
@@ -20,6 +20,11 @@ namespace UI
          */
         void gatherAvailableSavegames();
 
+        /**
+         * Refreshes the slot-labels and cancels a save-name which was being typed in
+         */
+        void onShow() override;
+
         void onCustomAction(const std::string& action) override;
 
         /**
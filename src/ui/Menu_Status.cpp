@@ -3,7 +3,11 @@
 //
 
 #include "Menu_Status.h"
+#include <components/VobClasses.h>
 #include <engine/BaseEngine.h>
+#include <engine/World.h>
+#include <logic/PlayerController.h>
+#include <logic/ScriptEngine.h>
 
 using namespace UI;
 
@@ -83,6 +87,20 @@ void Menu_Status::setExperienceNext(int xpNext)
     getItemScriptData("MENU_ITEM_LEVEL_NEXT").text[0] = std::to_string(xpNext);
 }
 
+void Menu_Status::onShow()
+{
+    Menu::onShow();
+
+    if (!m_Engine.getMainWorld().isValid())
+        return;
+
+    World::WorldInstance& world = m_Engine.getMainWorld().get();
+    VobTypes::NpcVobInformation player = VobTypes::asNpcVob(world, world.getScriptEngine().getPlayerEntity());
+
+    if (player.isValid())
+        player.playerController->updateStatusScreen(*this);
+}
+
 bool Menu_Status::onInputAction(Engine::ActionType action)
 {
     bool baseclassClose = Menu::onInputAction(action);
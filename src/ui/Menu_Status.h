@@ -46,6 +46,11 @@ namespace UI
          */
         bool onInputAction(Engine::ActionType action) override;
 
+        /**
+         * Fills in the current values of the player
+         */
+        void onShow() override;
+
         /**
          * Creates an instance of this class and appends it to the root UI-View
          * @return Instance of the class. Don't forget to delete!
@@ -19,6 +19,11 @@ namespace Flags
     Cli::Flag installGame("", "install-game", 2,
                                 " [installer-exe, target-folder] "
                                 "Unpacks the given Gothic-Installer-Executable without actually running the installer.");
+
+    Cli::Flag worldStats("", "world-stats", 3,
+                                " [game-dir, zen-file, target-json] "
+                                "Loads the given world and its assets without rendering and writes triangle-, vob-, "
+                                "texture- and waynet-statistics to the target-file.");
 }
 
 static void unpackVdf()
@@ -108,6 +113,12 @@ bool ::zTools::tryRunTools()
     {
         installGame();
         return true;
+    }else if(Flags::worldStats.isSet())
+    {
+        zTools::writeWorldStats(Flags::worldStats.getParam(0),
+                                Flags::worldStats.getParam(1),
+                                Flags::worldStats.getParam(2));
+        return true;
     }
 
     return false;
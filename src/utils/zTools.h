@@ -23,4 +23,14 @@ namespace zTools
      * @return Whether the extraction worked
      */
     bool extractInstaller(const std::string& file, const std::string& targetLocation);
+
+    /**
+     * Loads the given world with everything it references, without rendering anything, and writes statistics
+     * about it as json: Triangles, vobs, textures, waynet and the estimated memory needed to run it.
+     * @param gameDirectory Root-folder of the Gothic installation to take the archives from
+     * @param zen .ZEN-file to analyze, ie. "NEWWORLD.ZEN"
+     * @param target File to write the json to
+     * @return Whether the world could be analyzed
+     */
+    bool writeWorldStats(const std::string& gameDirectory, const std::string& zen, const std::string& target);
 }
@@ -0,0 +1,382 @@
+#include "zTools.h"
+#include <algorithm>
+#include <fstream>
+#include <list>
+#include <map>
+#include <numeric>
+#include <set>
+#include "Utils.h"
+#include <engine/Waynet.h>
+#include <json.hpp>
+#include <utils/logger.h>
+#include <vdfs/fileIndex.h>
+#include <zenload/zCMesh.h>
+#include <zenload/zCMorphMesh.h>
+#include <zenload/zCProgMeshProto.h>
+#include <zenload/zenParser.h>
+#include <zenload/ztex2dds.h>
+
+using json = nlohmann::json;
+
+/**
+ * Size of the header in front of the pixel-data of a DDS-file
+ */
+const size_t DDS_HEADER_SIZE = 128;
+
+namespace
+{
+    /**
+     * Sizes of the GPU-side buffers a mesh turns into
+     */
+    struct MeshStats
+    {
+        size_t vertices = 0;
+        size_t triangles = 0;
+        size_t vertexBytes = 0;
+        size_t indexBytes = 0;
+        std::set<std::string> textures;
+    };
+
+    struct WorldStats
+    {
+        std::map<std::string, MeshStats> meshes;
+
+        /**
+         * Size each texture takes up once loaded, 0 if it could not be found
+         */
+        std::map<std::string, size_t> textures;
+
+        std::map<std::string, size_t> vobsByClass;
+        std::map<std::string, size_t> vobsByVisual;
+        std::map<std::string, size_t> triggersByClass;
+        std::set<std::string> skippedVisuals;
+        size_t numVobs = 0;
+        size_t numFreepoints = 0;
+    };
+
+    bool isTrigger(const std::string& objectClass)
+    {
+        return objectClass.find("Trigger") != std::string::npos
+            || objectClass.find("zCMover") != std::string::npos
+            || objectClass.find("zCCodeMaster") != std::string::npos
+            || objectClass.find("zCMessageFilter") != std::string::npos;
+    }
+
+    /**
+     * Loads all archives the same way the engine does, see BaseEngine::loadArchives
+     */
+    void loadArchives(VDFS::FileIndex& idx, const std::string& gameDirectory)
+    {
+        auto byModTime = [](const std::string& lhs, const std::string& rhs) {
+            return VDFS::FileIndex::getLastModTime(lhs) > VDFS::FileIndex::getLastModTime(rhs);
+        };
+
+        for (const char* ext : {"mod", "zip"})
+        {
+            std::list<std::string> archives = Utils::getFilesInDirectory(gameDirectory + "/Data", ext, false);
+            archives.sort(byModTime);
+
+            for (std::string& s : archives)
+                idx.loadVDF(s);
+        }
+
+        std::list<std::string> vdfArchives = Utils::getFilesInDirectory(gameDirectory + "/Data", "vdf");
+        vdfArchives.sort(byModTime);
+
+        for (std::string& s : vdfArchives)
+            idx.loadVDF(s);
+
+        idx.finalizeLoad();
+    }
+
+    MeshStats statsFromPacked(const ZenLoad::PackedMesh& packed)
+    {
+        MeshStats s;
+        s.vertices = packed.vertices.size();
+        s.vertexBytes = packed.vertices.size() * sizeof(ZenLoad::WorldVertex);
+
+        for (const auto& sm : packed.subMeshes)
+        {
+            s.triangles += sm.indices.size() / 3;
+            s.indexBytes += sm.indices.size() * sizeof(uint32_t);
+
+            if (!sm.material.texture.empty())
+                s.textures.insert(Utils::toUpper(sm.material.texture));
+        }
+
+        return s;
+    }
+
+    /**
+     * Loads the given static- or morph-mesh, unless it was already seen
+     */
+    void addMesh(WorldStats& stats, const std::string& visual, VDFS::FileIndex& idx)
+    {
+        if (stats.meshes.find(visual) != stats.meshes.end() || stats.skippedVisuals.count(visual))
+            return;
+
+        // Same conversion to the compiled formats as GenericMeshAllocator::loadMeshVDF
+        std::string base = visual.substr(0, visual.size() - 4);
+        ZenLoad::PackedMesh packed;
+
+        if (Utils::endsWith(visual, ".3DS"))
+        {
+            ZenLoad::zCProgMeshProto zmsh(base + ".MRM", idx);
+
+            if (zmsh.getNumSubmeshes() != 0)
+                zmsh.packMesh(packed, 1.0f / 100.0f);
+        }
+        else
+        {
+            ZenLoad::zCMorphMesh zmm(base + ".MMB", idx);
+
+            if (zmm.getMesh().getNumSubmeshes() != 0)
+                zmm.getMesh().packMesh(packed, 1.0f / 100.0f);
+        }
+
+        if (packed.subMeshes.empty())
+        {
+            LogWarn() << "Failed to load mesh: " << visual;
+            stats.skippedVisuals.insert(visual);
+            return;
+        }
+
+        stats.meshes[visual] = statsFromPacked(packed);
+    }
+
+    void addVobs(WorldStats& stats, const std::vector<ZenLoad::zCVobData>& vobs, VDFS::FileIndex& idx)
+    {
+        for (const ZenLoad::zCVobData& v : vobs)
+        {
+            stats.numVobs++;
+            stats.vobsByClass[v.objectClass]++;
+
+            if (isTrigger(v.objectClass))
+                stats.triggersByClass[v.objectClass]++;
+
+            if (v.objectClass == "zCVobSpot:zCVob")
+                stats.numFreepoints++;
+
+            if (!v.visual.empty())
+            {
+                std::string visual = Utils::toUpper(v.visual);
+                stats.vobsByVisual[visual]++;
+
+                if (Utils::endsWith(visual, ".3DS") || Utils::endsWith(visual, ".MMS"))
+                    addMesh(stats, visual, idx);
+                else if (Utils::endsWith(visual, ".TGA"))
+                    stats.textures[visual] = 0; // Decal
+                else
+                    stats.skippedVisuals.insert(visual); // Models and particle-effects are not analyzed
+            }
+
+            addVobs(stats, v.childVobs, idx);
+        }
+    }
+
+    /**
+     * @return Size of the given texture once loaded, using the same lookup as TextureAllocator::loadTextureVDF.
+     *         0 if the texture doesn't exist.
+     */
+    size_t getTextureSize(const std::string& name, VDFS::FileIndex& idx)
+    {
+        std::vector<uint8_t> data;
+
+        if (Utils::endsWith(name, ".TGA"))
+            idx.getFileData(name.substr(0, name.size() - 4) + "-C.TEX", data);
+
+        if (!data.empty())
+        {
+            std::vector<uint8_t> dds;
+            ZenLoad::convertZTEX2DDS(data, dds);
+
+            return dds.size() > DDS_HEADER_SIZE ? dds.size() - DDS_HEADER_SIZE : 0;
+        }
+
+        // Uncompiled texture. Gets uploaded as RGBA8, which is about the size of an uncompressed TGA.
+        idx.getFileData(name, data);
+        return data.size();
+    }
+
+    /**
+     * @return Number of groups of waypoints which can't reach each other
+     */
+    size_t countWaynetComponents(const World::Waynet::WaynetInstance& waynet)
+    {
+        std::vector<bool> visited(waynet.waypoints.size(), false);
+        std::vector<size_t> open;
+        size_t components = 0;
+
+        for (size_t i = 0; i < waynet.waypoints.size(); i++)
+        {
+            if (visited[i])
+                continue;
+
+            components++;
+            visited[i] = true;
+            open.push_back(i);
+
+            while (!open.empty())
+            {
+                size_t wp = open.back();
+                open.pop_back();
+
+                for (size_t e : waynet.waypoints[wp].edges)
+                {
+                    if (!visited[e])
+                    {
+                        visited[e] = true;
+                        open.push_back(e);
+                    }
+                }
+            }
+        }
+
+        return components;
+    }
+}
+
+bool ::zTools::writeWorldStats(const std::string& gameDirectory, const std::string& zen, const std::string& target)
+{
+    VDFS::FileIndex idx;
+    loadArchives(idx, gameDirectory);
+
+    if (!idx.hasFile(zen))
+    {
+        LogError() << "Failed to find world: " << zen;
+        return false;
+    }
+
+    LogInfo() << "Reading world: " << zen;
+
+    ZenLoad::ZenParser parser(zen, idx);
+    parser.readHeader();
+
+    ZenLoad::oCWorldData world;
+    parser.readWorld(world);
+
+    json j;
+    j["world"] = zen;
+
+    // Worldmesh
+    size_t worldMeshVertexBytes = 0;
+    size_t worldMeshIndexBytes = 0;
+    WorldStats stats;
+    {
+        ZenLoad::PackedMesh packed;
+        parser.getWorldMesh()->packMesh(packed, 0.01f, false);
+
+        MeshStats s = statsFromPacked(packed);
+        worldMeshVertexBytes = s.vertexBytes;
+        worldMeshIndexBytes = s.indexBytes;
+
+        // Triangles per material, to see which one blew up
+        std::map<std::string, size_t> trianglesByTexture;
+        for (const auto& sm : packed.subMeshes)
+            trianglesByTexture[Utils::toUpper(sm.material.texture)] += sm.indices.size() / 3;
+
+        for (const std::string& t : s.textures)
+            stats.textures[t] = 0;
+
+        json& jmesh = j["worldmesh"];
+        jmesh["vertices"] = s.vertices;
+        jmesh["triangles"] = s.triangles;
+        jmesh["materials"] = packed.subMeshes.size();
+        jmesh["trianglesByTexture"] = trianglesByTexture;
+    }
+
+    LogInfo() << "Reading vobs and their visuals...";
+
+    addVobs(stats, world.rootVobs, idx);
+
+    // Unique meshes
+    size_t meshVertexBytes = 0;
+    size_t meshIndexBytes = 0;
+    size_t meshTriangles = 0;
+    {
+        json& jmeshes = j["meshes"];
+        jmeshes = json::object();
+
+        for (const auto& m : stats.meshes)
+        {
+            json& jm = jmeshes[m.first];
+            jm["vertices"] = m.second.vertices;
+            jm["triangles"] = m.second.triangles;
+            jm["materials"] = m.second.textures.size();
+            jm["instances"] = stats.vobsByVisual[m.first];
+
+            meshVertexBytes += m.second.vertexBytes;
+            meshIndexBytes += m.second.indexBytes;
+            meshTriangles += m.second.triangles * stats.vobsByVisual[m.first];
+
+            for (const std::string& t : m.second.textures)
+                stats.textures[t] = 0;
+        }
+    }
+
+    // Textures of worldmesh, meshes and decals
+    size_t textureBytes = 0;
+    std::vector<std::string> missingTextures;
+    for (auto& t : stats.textures)
+    {
+        t.second = getTextureSize(t.first, idx);
+        textureBytes += t.second;
+
+        if (t.second == 0)
+            missingTextures.push_back(t.first);
+    }
+
+    j["vobs"]["total"] = stats.numVobs;
+    j["vobs"]["byClass"] = stats.vobsByClass;
+    j["vobs"]["byVisual"] = stats.vobsByVisual;
+    j["vobs"]["trianglesDrawn"] = meshTriangles;
+    j["vobs"]["visualsNotAnalyzed"] = std::vector<std::string>(stats.skippedVisuals.begin(), stats.skippedVisuals.end());
+
+    size_t numTriggers = std::accumulate(stats.triggersByClass.begin(), stats.triggersByClass.end(), size_t(0),
+                                         [](size_t n, const std::pair<const std::string, size_t>& p) { return n + p.second; });
+
+    j["triggers"]["total"] = numTriggers;
+    j["triggers"]["byClass"] = stats.triggersByClass;
+
+    j["textures"]["unique"] = stats.textures.size();
+    j["textures"]["bytes"] = textureBytes;
+    j["textures"]["bySize"] = stats.textures;
+    j["textures"]["missing"] = missingTextures;
+
+    // Waynet
+    {
+        World::Waynet::WaynetInstance waynet = World::Waynet::makeWaynetFromZen(world);
+
+        json& jwaynet = j["waynet"];
+        jwaynet["waypoints"] = waynet.waypoints.size();
+        jwaynet["edges"] = world.waynet.edges.size();
+        jwaynet["components"] = countWaynetComponents(waynet);
+        jwaynet["freepoints"] = stats.numFreepoints;
+        jwaynet["underWater"] = std::count_if(waynet.waypoints.begin(), waynet.waypoints.end(),
+                                              [](const World::Waynet::Waypoint& wp) { return wp.underWater; });
+    }
+
+    // What the engine keeps around for this world. Entities and scripts are not included.
+    {
+        json& jmem = j["estimatedMemory"];
+        jmem["worldmeshVertexBuffer"] = worldMeshVertexBytes;
+        jmem["worldmeshIndexBuffer"] = worldMeshIndexBytes;
+        jmem["meshVertexBuffers"] = meshVertexBytes;
+        jmem["meshIndexBuffers"] = meshIndexBytes;
+        jmem["textures"] = textureBytes;
+        jmem["total"] = worldMeshVertexBytes + worldMeshIndexBytes + meshVertexBytes + meshIndexBytes + textureBytes;
+    }
+
+    // Keys come out sorted, so the files of two versions of a mod can be diffed directly
+    std::ofstream f(target);
+    if (!f.is_open())
+    {
+        LogError() << "Failed to open for writing: " << target;
+        return false;
+    }
+
+    f << Utils::iso_8859_1_to_utf8(j.dump(4));
+
+    LogInfo() << "Wrote world statistics to: " << target;
+    return true;
+}